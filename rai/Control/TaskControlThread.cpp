@@ -35,7 +35,7 @@ TaskControlThread::TaskControlThread(const rai::KinematicWorld& world)
   Kd_base = zeros(realWorld.q.N);
 
   for(rai::Joint *j:realWorld.fwdActiveJoints) {
-    arr *gains = j->frame.ats.find<arr>("gains");
+    arr *gains = j->frame.ats().find<arr>("gains");
     if(gains) {
       for(uint i=0; i<j->qDim(); i++) {
         Kp_base(j->qIndex+i)=gains->elem(0);
@@ -60,6 +60,8 @@ void TaskControlThread::open() {
 }
 
 void TaskControlThread::step() {
+  rai::ArrayArena arena; //the temporaries of this step; members and the written variables are copied out
+  
   rai::Frame *transF = realWorld.getFrameByName("worldTranslationRotation", false);
   rai::Joint *trans = (transF?transF->joint:NULL);
   
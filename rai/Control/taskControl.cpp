@@ -328,7 +328,7 @@ void TaskControlMethods::lockJointGroup(const char* groupname, rai::KinematicWor
   if(!lockJoints.N) lockJoints = consts<byte>(false, world.q.N);
   rai::Joint *j;
   for(rai::Frame *f : world.frames) if((j=f->joint)) {
-      if(f->ats[groupname]) {
+      if(f->ats()[groupname]) {
         for(uint i=0; i<j->qDim(); i++) {
           lockJoints(j->qIndex+i) = lockThem;
           if(lockThem && world.qdot.N) world.qdot(j->qIndex+i) = 0.;
@@ -48,12 +48,301 @@ const bool lapackSupported=true;
 #else
 const bool lapackSupported=false;
 #endif
-uint64_t globalMemoryTotal=0, globalMemoryBound=1ull<<30; //this is 1GB
+std::atomic<uint64_t> globalMemoryTotal(0);
+uint64_t globalMemoryBound=1ull<<30; //this is 1GB
 bool globalMemoryStrict=false;
+std::atomic<uint64_t> globalMemoryAllocations(0);
+std::atomic<uint64_t> globalMemoryCopies(0);
 const char* arrayElemsep=" ";
 const char* arrayLinesep="\n ";
 const char* arrayBrackets="  ";
 
+//===========================================================================
+//
+// ArrayPool
+//
+
+bool ArrayPool::enabled=false;
+uint ArrayPool::maxCached=64;
+
+namespace {
+
+/// the free lists and counters of one thread; the counters are only written by the owner thread
+struct PoolCache {
+  void *free[ArrayPool::numClasses];
+  std::atomic<uint64_t> cached[ArrayPool::numClasses];
+  std::atomic<uint64_t> allocs[ArrayPool::numClasses], hits[ArrayPool::numClasses], frees[ArrayPool::numClasses];
+  PoolCache();
+  ~PoolCache();
+  void release();
+};
+
+/// all live caches, and the counters of the caches of finished threads (never destroyed, as Arrays may outlive it)
+struct PoolRegistry {
+  Mutex mutex;
+  std::vector<PoolCache*> caches;
+  ArrayPool::Stats retired[ArrayPool::numClasses];
+};
+PoolRegistry& poolRegistry() { static PoolRegistry *reg = new PoolRegistry; return *reg; }
+
+thread_local PoolCache *poolCache=NULL;
+thread_local bool poolCacheDead=false;
+
+PoolCache::PoolCache() {
+  for(uint c=0; c<ArrayPool::numClasses; c++) { free[c]=NULL; cached[c]=0; allocs[c]=0; hits[c]=0; frees[c]=0; }
+  PoolRegistry& reg = poolRegistry();
+  auto lock = reg.mutex();
+  reg.caches.push_back(this);
+}
+
+PoolCache::~PoolCache() {
+  release();
+  PoolRegistry& reg = poolRegistry();
+  auto lock = reg.mutex();
+  for(uint c=0; c<ArrayPool::numClasses; c++) {
+    reg.retired[c].allocs += allocs[c];
+    reg.retired[c].hits += hits[c];
+    reg.retired[c].frees += frees[c];
+  }
+  for(uint i=0; i<reg.caches.size(); i++) if(reg.caches[i]==this) { reg.caches.erase(reg.caches.begin()+i); break; }
+  poolCache=NULL;
+  poolCacheDead=true; //Arrays destroyed after this go straight to free()
+}
+
+void PoolCache::release() {
+  for(uint c=0; c<ArrayPool::numClasses; c++) {
+    while(free[c]) { void *next=*(void**)free[c]; ::free(free[c]); free[c]=next; }
+    globalMemoryTotal -= cached[c]*ArrayPool::classSize(c);
+    cached[c]=0;
+  }
+}
+
+PoolCache* getPoolCache() {
+  if(poolCache) return poolCache;
+  if(poolCacheDead) return NULL;
+  static thread_local PoolCache cache;
+  poolCache=&cache;
+  return poolCache;
+}
+
+/// (no atomic read-modify-write needed: only the owner thread writes, getStats only reads)
+/// the blocks of a thread's ArrayArena scopes, and the top of the innermost scope (NULL if none)
+struct ArenaState {
+  std::vector<char*> chunks;
+  std::vector<size_t> sizes;
+  uint chunk=0;
+  size_t top=0;
+  const char *scopeTop=NULL;
+  ~ArenaState();
+  void* allocate(size_t bytes);
+  bool free(void *p, size_t bytes);
+};
+
+thread_local ArenaState *arenaState=NULL;
+thread_local bool arenaRequested=false;
+
+ArenaState* getArenaState() {
+  if(!arenaState) { static thread_local ArenaState state; arenaState=&state; }
+  return arenaState;
+}
+
+void accountMemory(size_t bytes);
+
+ArenaState::~ArenaState() {
+  for(uint i=0; i<chunks.size(); i++) { ::free(chunks[i]); globalMemoryTotal -= sizes[i]; }
+  arenaState=NULL;
+}
+
+void* ArenaState::allocate(size_t bytes) {
+  size_t size = (bytes+15)&~size_t(15);
+  for(;;) {
+    if(chunk<chunks.size() && top+size<=sizes[chunk]) {
+      void *p = chunks[chunk]+top;
+      top += size;
+      return p;
+    }
+    if(chunk+1<chunks.size()) { chunk++; top=0; continue; }
+    size_t n = size>(1<<20) ? size : (1<<20);
+    accountMemory(n);
+    char *c = (char*)malloc(n);
+    if(!c) { globalMemoryTotal -= n; throw std::bad_alloc(); }
+    chunks.push_back(c);
+    sizes.push_back(n);
+    chunk=chunks.size()-1;
+    top=0;
+  }
+}
+
+bool ArenaState::free(void *p, size_t bytes) {
+  for(uint i=0; i<chunks.size(); i++) if(p>=chunks[i] && p<chunks[i]+sizes[i]) {
+      size_t size = (bytes+15)&~size_t(15);
+      if(i==chunk && (char*)p+size==chunks[i]+top) top -= size; //the last allocation: pop it
+      return true;
+    }
+  return false;
+}
+
+inline void add(std::atomic<uint64_t>& x, int64_t d=1) { x.store(x.load(std::memory_order_relaxed)+d, std::memory_order_relaxed); }
+
+void accountMemory(size_t bytes) {
+  uint64_t total = (globalMemoryTotal += bytes);
+  if(total>globalMemoryBound) { //helpers to limit global memory (e.g. to avoid crashing a machine)
+    if(globalMemoryStrict) { //undo changes then throw an error
+      globalMemoryTotal -= bytes;
+      HALT("strict memory limit exceeded: allocating " <<(bytes>>20) <<"MB (total=" <<(total>>20) <<"M, bound=" <<(globalMemoryBound>>20) <<"M)");
+    } else if(bytes>>20 || total-bytes<=globalMemoryBound) { //just give a warning
+      RAI_MSG("allocating " <<(bytes>>20) <<"MB (total=" <<(total>>20) <<"M, bound=" <<(globalMemoryBound>>20) <<"M)...");
+    }
+  }
+}
+
+}
+
+//the scope boundaries are stack frame addresses: the constructor and inScope must have their own frames, i.e., must
+//never be inlined into the caller (which would happen with LTO or once they move into the header)
+__attribute__((noinline)) ArrayArena::ArrayArena() {
+  ArenaState *a = getArenaState();
+  prevTop = a->scopeTop;
+  markChunk = a->chunk;
+  markTop = a->top;
+  //not the address of this: the locals of the scope's own function may lie on either side of it. The frame of this
+  //(out-of-line) constructor lies below all of them, where the frames of the calls within the scope will be
+  a->scopeTop = (const char*)__builtin_frame_address(0);
+}
+
+ArrayArena::~ArrayArena() {
+  ArenaState *a = arenaState;
+  a->chunk = markChunk;
+  a->top = markTop;
+  a->scopeTop = prevTop;
+}
+
+size_t ArrayArena::capacity() {
+  size_t n=0;
+  if(arenaState) for(size_t s:arenaState->sizes) n+=s;
+  return n;
+}
+
+void ArrayArena::release() {
+  if(!arenaState) return;
+  CHECK(!arenaState->scopeTop, "can't release the arena within a scope");
+  for(uint i=0; i<arenaState->chunks.size(); i++) { ::free(arenaState->chunks[i]); globalMemoryTotal -= arenaState->sizes[i]; }
+  arenaState->chunks.clear();
+  arenaState->sizes.clear();
+  arenaState->chunk=0;
+  arenaState->top=0;
+}
+
+__attribute__((noinline)) bool ArrayArena::inScope(const void *array) { //(noinline: see the constructor)
+  if(!arenaState || !arenaState->scopeTop) return false;
+  char here; //the stack grows downwards: locals of calls within the scope lie between here and the scope object
+  return (const char*)array>&here && (const char*)array<arenaState->scopeTop;
+}
+
+bool ArrayArena::owns(const void *p) {
+  if(!arenaState) return false;
+  for(uint i=0; i<arenaState->chunks.size(); i++) if(p>=arenaState->chunks[i] && p<arenaState->chunks[i]+arenaState->sizes[i]) return true;
+  return false;
+}
+
+bool ArrayArena::request(const void *array) {
+  if(!inScope(array)) return false;
+  arenaRequested=true;
+  return true;
+}
+
+void ArrayArena::endRequest() { arenaRequested=false; }
+
+int ArrayPool::sizeClass(size_t bytes) {
+  if(bytes>maxBytes) return -1;
+  if(bytes<=128) return bytes ? (bytes-1)/16 : 0;
+  uint e=63-__builtin_clzll(bytes-1); //bytes in (2^e, 2^(e+1)]
+  return 8 + (e-7)*4 + ((bytes-1-(1ull<<e)) >> (e-2));
+}
+
+size_t ArrayPool::classSize(uint c) {
+  if(c<8) return 16*(c+1);
+  uint e = 7 + (c-8)/4;
+  return (1ull<<e) + ((c-8)%4+1)*(1ull<<(e-2));
+}
+
+void* ArrayPool::allocate(size_t bytes) {
+  if(arenaRequested) { //only the buffer itself, not what its elements' constructors allocate
+    arenaRequested=false;
+    return arenaState->allocate(bytes);
+  }
+  int c = sizeClass(bytes);
+  if(c<0) {
+    accountMemory(bytes);
+    void *p = malloc(bytes);
+    if(!p) { globalMemoryTotal -= bytes; throw std::bad_alloc(); }
+    return p;
+  }
+  PoolCache *cache = enabled ? getPoolCache() : NULL;
+  if(cache) {
+    add(cache->allocs[c]);
+    if(cache->free[c]) {
+      add(cache->hits[c]);
+      void *p = cache->free[c];
+      cache->free[c] = *(void**)p;
+      add(cache->cached[c], -1);
+      return p; //(cached blocks are still accounted for)
+    }
+  }
+  size_t size = classSize(c);
+  accountMemory(size);
+  void *p = malloc(size);
+  if(!p) { globalMemoryTotal -= size; throw std::bad_alloc(); }
+  return p;
+}
+
+void ArrayPool::deallocate(void* p, size_t bytes) noexcept {
+  if(!p) return;
+  if(arenaState && arenaState->chunks.size() && arenaState->free(p, bytes)) return;
+  int c = sizeClass(bytes);
+  PoolCache *cache = (enabled && c>=0) ? getPoolCache() : NULL;
+  if(cache) {
+    add(cache->frees[c]);
+    if(cache->cached[c].load(std::memory_order_relaxed)<maxCached) {
+      *(void**)p = cache->free[c];
+      cache->free[c] = p;
+      add(cache->cached[c]);
+      return;
+    }
+  }
+  globalMemoryTotal -= (c<0 ? bytes : classSize(c));
+  ::free(p);
+}
+
+void ArrayPool::getStats(Stats *stats) {
+  PoolRegistry& reg = poolRegistry();
+  auto lock = reg.mutex();
+  for(uint c=0; c<numClasses; c++) {
+    stats[c] = reg.retired[c];
+    for(PoolCache *cache:reg.caches) {
+      stats[c].allocs += cache->allocs[c].load(std::memory_order_relaxed);
+      stats[c].hits += cache->hits[c].load(std::memory_order_relaxed);
+      stats[c].frees += cache->frees[c].load(std::memory_order_relaxed);
+      stats[c].cached += cache->cached[c].load(std::memory_order_relaxed);
+    }
+  }
+}
+
+void ArrayPool::report(std::ostream& os) {
+  Stats stats[numClasses];
+  getStats(stats);
+  os <<"ArrayPool (" <<(enabled?"enabled":"disabled") <<", " <<poolRegistry().caches.size() <<" thread caches)" <<endl;
+  for(uint c=0; c<numClasses; c++) if(stats[c].allocs || stats[c].frees) {
+      os <<"  class " <<classSize(c) <<"B: allocs=" <<stats[c].allocs
+         <<" hits=" <<stats[c].hits <<" (" <<(100*stats[c].hits/(stats[c].allocs?stats[c].allocs:1)) <<"%)"
+         <<" frees=" <<stats[c].frees <<" cached=" <<stats[c].cached <<endl;
+    }
+}
+
+void ArrayPool::releaseThreadCache() {
+  if(poolCache) poolCache->release();
+}
+
 //===========================================================================
 }
 
@@ -1523,7 +1812,7 @@ void lapack_EigenDecomp(const arr& symmA, arr& Evals, arr& Evecs) {
   integer info, wn=work.N;
   if(!!Evecs) {
     dsyev_((char*)"V", (char*)"L", &N, symmAcopy.p, &N, Evals.p, work.p, &wn, &info);
-    Evecs = symmAcopy;
+    Evecs = std::move(symmAcopy);
   } else {
     dsyev_((char*)"N", (char*)"L", &N, symmAcopy.p, &N, Evals.p, work.p, &wn, &info);
   }
@@ -1698,6 +1987,7 @@ bool lapack_isPositiveSemiDefinite(const arr& symmA) { NICO; }
 void lapack_inverseSymPosDef(arr& Ainv, const arr& A) { NICO; }
 arr lapack_kSmallestEigenValues_sym(const arr& A, uint k) { NICO; }
 arr lapack_Ainv_b_sym(const arr& A, const arr& b) {
+  if(isRowShifted(A)) return ((RowShifted*)A.special)->Ainv_b_sym(b);
   arr invA;
   inverse(invA, A);
   return invA*b;
@@ -1896,6 +2186,65 @@ arr RowShifted::At_A() {
   return R;
 }
 
+/// solves A x = b for a symmetric pos-def A (stored as upper triangle, rowShift(i)==i) by an envelope Cholesky:
+/// row i of the factor only extends to the last non-zero column of rows 0..i, so variable slice dimensions
+/// are not padded to the packed width Z.d1 (as in dpbsv) -- for k-order KOMO problems this is O(T d^3);
+/// other shifts are solved densely. (lapack_Ainv_b_sym uses it for RowShifted matrices if there is no lapack)
+arr RowShifted::Ainv_b_sym(const arr& b) {
+  CHECK(symmetric, "this is not a symmetric matrix");
+  CHECK_EQ(Z.d0, real_d1, "");
+  CHECK_EQ(b.N, Z.d0, "");
+  uint n=Z.d0, w=Z.d1;
+  for(uint i=0; i<n; i++) if(rowShift.p[i]!=i) return lapack_Ainv_b_sym(unpackRowShifted(Z), b);
+  
+  //-- envelope: end(i) = 1 + last non-zero column of rows 0..i (monotone, so Cholesky fill-in stays inside)
+  uintA end(n);
+  for(uint i=0; i<n; i++) {
+    double* Zi = Z.p+i*w;
+    uint len=w;
+    if(i+len>n) len=n-i;
+    while(len>1 && Zi[len-1]==0.) len--;
+    end.p[i] = i+len;
+    if(i && end.p[i-1]>end.p[i]) end.p[i]=end.p[i-1];
+  }
+  
+  //-- factor A = U^T U in place of a packed copy (U_ij is stored at U[i*w + j-i])
+  arr U(n, w);
+  memmove(U.p, Z.p, Z.N*sizeof(double));
+  for(uint i=0; i<n; i++) {
+    double* Ui = U.p+i*w;
+    if(!(Ui[0]>0.)) THROW("RowShifted::Ainv_b_sym: matrix not pos-def at row " <<i <<" (pivot " <<Ui[0] <<")");
+    double d = ::sqrt(Ui[0]);
+    Ui[0] = d;
+    uint len = end.p[i]-i;
+    for(uint j=1; j<len; j++) Ui[j] /= d;
+    for(uint k=1; k<len; k++) {
+      double uik = Ui[k];
+      if(uik==0.) continue;
+      double* Uk = U.p+(i+k)*w; //row i+k: its column i+k+j' sits at Uk[j']
+      for(uint j=k; j<len; j++) Uk[j-k] -= uik*Ui[j];
+    }
+  }
+  
+  //-- solve U^T y = b, then U x = y
+  arr x = b;
+  x.reshape(n);
+  for(uint i=0; i<n; i++) {
+    double* Ui = U.p+i*w;
+    double xi = (x.p[i] /= Ui[0]);
+    uint len = end.p[i]-i;
+    for(uint j=1; j<len; j++) x.p[i+j] -= Ui[j]*xi;
+  }
+  for(uint i=n; i--;) {
+    double* Ui = U.p+i*w;
+    double s = x.p[i];
+    uint len = end.p[i]-i;
+    for(uint j=1; j<len; j++) s -= Ui[j]*x.p[i+j];
+    x.p[i] = s/Ui[0];
+  }
+  return x;
+}
+
 arr RowShifted::A_At() {
   //-- determine pack_d1 for the resulting symmetric matrix
   uint pack_d1=1;
@@ -20,6 +20,7 @@
 #include <functional>
 #include <memory>
 #include <vector>
+#include <atomic>
 
 //-- don't require previously defined iterators
 #define for_list(Type, it, X)     Type *it=NULL; for(uint it##_COUNT=0;   it##_COUNT<X.N && ((it=X(it##_COUNT)) || true); it##_COUNT++)
@@ -36,7 +37,10 @@ struct SpecialArray;
 namespace rai {
 extern bool useLapack;
 extern const bool lapackSupported;
-extern uint64_t globalMemoryTotal, globalMemoryBound;
+extern std::atomic<uint64_t> globalMemoryTotal; ///< bytes currently held for Array buffers (including the blocks cached by ArrayPool)
+extern uint64_t globalMemoryBound;
+extern std::atomic<uint64_t> globalMemoryAllocations; ///< counts all heap (re)allocations of Array buffers
+extern std::atomic<uint64_t> globalMemoryCopies; ///< counts all element-wise copies of (non-empty) Arrays by copy construction or assignment
 extern bool globalMemoryStrict;
 extern const char* arrayElemsep;
 extern const char* arrayLinesep;
@@ -48,6 +52,139 @@ template<class T> bool greater(const T& a, const T& b) { return a>b; }
 template<class T> bool greaterEqual(const T& a, const T& b) { return a>=b; }
 } //namespace
 
+//===========================================================================
+//
+// memory backend of Array buffers
+//
+
+namespace rai {
+
+/** The memory of all Array buffers goes through ArrayPool: buffers up to 64KB are rounded up to one of
+  numClasses size classes (steps of 16 bytes up to 128, then 4 steps per power of two, i.e., at most 25% slack)
+  and, if enabled, freed blocks are cached in thread-local per-class free lists and reused by the next allocation
+  of that class in the same thread -- no malloc/free for the short-lived temporaries. Larger buffers always go to
+  malloc. Blocks may be freed on any thread (they are then cached there). The flag can be toggled at any time.
+  globalMemoryTotal is updated (and checked against globalMemoryBound) whenever memory goes to or comes from malloc. */
+struct ArrayPool {
+  static const uint numClasses = 44;
+  static const size_t maxBytes = 1<<16; ///< larger buffers are not pooled
+  static bool enabled;   ///< cache freed blocks (default: false -> plain malloc/free of the rounded sizes)
+  static uint maxCached; ///< max number of cached blocks per thread and class
+
+  struct Stats { uint64_t allocs=0, hits=0, frees=0, cached=0; }; ///< hits: allocations served from a cache
+  
+  static void* allocate(size_t bytes);
+  static void deallocate(void* p, size_t bytes) noexcept;
+  static size_t classSize(uint c);
+  static int sizeClass(size_t bytes); ///< -1 for unpooled sizes
+  static void getStats(Stats *stats); ///< per class (numClasses entries), summed over all threads (approximate while other threads run)
+  static void report(std::ostream& os);
+  static void releaseThreadCache();   ///< frees all blocks cached by the calling thread
+};
+
+/** RAII scope for the temporaries of hot computations: while it lives, every Array that is a local of the functions
+  called within the scope (i.e., on this thread's stack below the scope's own function, destroyed before the scope
+  ends) bump-allocates its buffer from a reusable thread-local block; the scope's destructor releases all of it at
+  once. Arrays that outlive the scope -- locals of the scope's function, outputs, members, heap or static arrays --
+  are not affected and keep using ArrayPool: assigning (or moving) a temporary to them copies it out. Scopes may be
+  nested. */
+struct ArrayArena {
+  ArrayArena();
+  ~ArrayArena();
+  
+  static size_t capacity(); ///< bytes of the calling thread's arena blocks (kept for reuse until the thread ends)
+  static void release();    ///< frees the calling thread's arena blocks (outside of any scope)
+  static bool inScope(const void *array); ///< is the array a local of a call within the innermost scope (of the calling thread)?
+  static bool owns(const void *p);        ///< is p in the calling thread's arena blocks?
+  static bool request(const void *array); ///< (sort of private) resizeMEM: the next allocation is for this array
+  static void endRequest();               ///< (sort of private)
+  
+private:
+  const char *prevTop;
+  uint markChunk;
+  size_t markTop;
+  ArrayArena(const ArrayArena&) = delete;
+  ArrayArena& operator=(const ArrayArena&) = delete;
+};
+
+/// the inline buffer of small Arrays: up to 64 bytes (e.g. 8 doubles) live within the Array object, without any heap
+/// allocation; only for arithmetic element types (Arrays of incomplete types must remain declarable). The cost is the
+/// object size: sizeof(arr) is 176 instead of 80 bytes, which counts for large Arrays of Arrays (arrA) and for structs
+/// holding many arrs. References to an inline buffer point into the owning Array object (see referTo)
+struct ArrayInlineBuffer {
+  static const uint bytes = 64;
+  alignas(16) char buf[bytes];
+  bool used=false;
+};
+template<class T, bool small=std::is_arithmetic<T>::value> struct ArrayInline {
+  static const uint N = ArrayInlineBuffer::bytes/sizeof(T);
+  ArrayInlineBuffer inlineBuffer;
+  ArrayInlineBuffer* inlineStorage() { return &inlineBuffer; }
+};
+template<class T> struct ArrayInline<T, false> {
+  static const uint N = 0;
+  ArrayInlineBuffer* inlineStorage() { return NULL; }
+};
+
+/// the std allocator that routes Array buffers through ArrayPool -- or into the Array's inline buffer, if it fits
+template<class T> struct ArrayAllocator {
+  typedef T value_type;
+  ArrayInlineBuffer *store; ///< the inline buffer of the owning Array (or NULL)
+  ArrayAllocator(ArrayInlineBuffer *_store=NULL) noexcept : store(_store) {}
+  template<class U> ArrayAllocator(const ArrayAllocator<U>& a) noexcept : store(a.store) {}
+  T* allocate(size_t n) {
+    if(store && !store->used && n*sizeof(T)<=ArrayInlineBuffer::bytes) { store->used=true; return (T*)store->buf; }
+    return (T*)ArrayPool::allocate(n*sizeof(T));
+  }
+  void deallocate(T* p, size_t n) noexcept {
+    if(store && (char*)p==store->buf) { store->used=false; return; }
+    ArrayPool::deallocate(p, n*sizeof(T));
+  }
+};
+template<class T, class U> bool operator==(const ArrayAllocator<T>& a, const ArrayAllocator<U>& b) { return a.store==b.store; }
+template<class T, class U> bool operator!=(const ArrayAllocator<T>& a, const ArrayAllocator<U>& b) { return a.store!=b.store; }
+
+} //namespace
+
+//===========================================================================
+//
+// SIMD kernels of element-wise operations
+//
+
+namespace rai {
+
+/** AVX2 and AVX-512 kernels (arraySimd.cpp) for the element-wise operators, some unary functions and reductions of
+  double and float Arrays with at least simdMinN elements. The instruction set is chosen at runtime by CPU detection.
+  All results are identical to those of the scalar loops, except for exp and sigm (a polynomial approximation, within
+  about 1 ulp) and the sums (sumOfSqr, scalarProduct: another summation order) */
+enum SimdOp { SIMD_none=0, SIMD_add, SIMD_sub, SIMD_mul, SIMD_div, SIMD_exp, SIMD_sqrt, SIMD_fabs, SIMD_sigm };
+extern int simdLevel;           ///< 0: scalar loops only, 1: AVX2 (+FMA), 2: AVX-512 -- initialized to simdSupported; may be lowered
+extern const int simdSupported; ///< the level the CPU (and OS) supports
+const uint simdMinN = 16;       ///< smaller Arrays always use the scalar loops
+
+//-- (sort of private) the kernels return false when they don't apply (element type, simdLevel, op): the caller then
+//   runs its scalar loop
+template<class T> bool simd_update(SimdOp op, T *x, const T *y, uint n) { return false; }
+template<class T> bool simd_updateScalar(SimdOp op, T *x, T y, uint n) { return false; }
+template<class T> bool simd_unary(SimdOp op, T *x, const T *y, uint n) { return false; }
+template<class T> bool simd_sumOfSqr(T& s, const T *x, uint n) { return false; }
+template<class T> bool simd_scalarProduct(T& s, const T *x, const T *y, uint n) { return false; }
+template<class T> bool simd_maxDiff(T& m, const T *x, const T *y, uint n) { return false; }
+bool simd_update(SimdOp op, double *x, const double *y, uint n); ///< x[i] op= y[i] (add, sub, mul, div)
+bool simd_update(SimdOp op, float *x, const float *y, uint n);
+bool simd_updateScalar(SimdOp op, double *x, double y, uint n); ///< x[i] op= y (add, sub, mul, div)
+bool simd_updateScalar(SimdOp op, float *x, float y, uint n);
+bool simd_unary(SimdOp op, double *x, const double *y, uint n); ///< x[i] = op(y[i]) (exp, sqrt, fabs, sigm); x may be y
+bool simd_unary(SimdOp op, float *x, const float *y, uint n);
+bool simd_sumOfSqr(double& s, const double *x, uint n);
+bool simd_sumOfSqr(float& s, const float *x, uint n);
+bool simd_scalarProduct(double& s, const double *x, const double *y, uint n);
+bool simd_scalarProduct(float& s, const float *x, const float *y, uint n);
+bool simd_maxDiff(double& m, const double *x, const double *y, uint n); ///< max_i |x[i]-y[i]|
+bool simd_maxDiff(float& m, const float *x, const float *y, uint n);
+
+} //namespace
+
 //===========================================================================
 //
 // Array class
@@ -68,7 +205,7 @@ template<class T> struct ArrayIterationEnumerated;
   Please see also the reference for the \ref array.h
   header, which contains lots of functions that can be applied on
   Arrays. */
-template<class T> struct Array : std::vector<T> {
+template<class T> struct Array : ArrayInline<T>, std::vector<T, ArrayAllocator<T>> {
   T *p;     ///< the pointer on the linear memory allocated
   uint N;   ///< number of elements
   uint nd;  ///< number of dimensions
@@ -83,12 +220,13 @@ template<class T> struct Array : std::vector<T> {
   //-- special: arrays can be sparse/packed/etc and augmented with aux data to support this
   SpecialArray *special; ///< arbitrary auxiliary data, depends on special
   
-  typedef std::vector<T> vec_type;
+  typedef std::vector<T, ArrayAllocator<T>> vec_type;
   typedef std::function<bool(const T& a, const T& b)> ElemCompare;
   
   /// @name constructors
   Array();
   Array(const Array<T>& a);                 //copy constructor
+  Array(Array<T>&& a);                      //move constructor (see operator=(Array&&))
   explicit Array(uint D0);
   explicit Array(uint D0, uint D1);
   explicit Array(uint D0, uint D1, uint D2);
@@ -106,6 +244,7 @@ template<class T> struct Array : std::vector<T> {
   Array<T>& operator=(std::initializer_list<T> values);
   Array<T>& operator=(const T& v);
   Array<T>& operator=(const Array<T>& a);
+  Array<T>& operator=(Array<T>&& a);
   Array<T>& operator=(const std::vector<T>& values);
   
   /// @name iterators
@@ -157,14 +296,14 @@ template<class T> struct Array : std::vector<T> {
   void setCarray(const T *buffer, uint D0);
   void setCarray(const T **buffer, uint D0, uint D1);
   void referTo(const T *buffer, uint n);
-  void referTo(const Array<T>& a);
+  void referTo(const Array<T>& a);         //if a is inline (small), the reference points into the object a: it must not outlive a
   void referToRange(const Array<T>& a, int i, int I); // -> referTo(a,{i,I})
   void referToRange(const Array<T>& a, int i, int j, int J); // -> referTo(a,{i,I})
   void referToRange(const Array<T>& a, int i, int j, int k, int K); // -> referTo(a,{i,I})
   void referToDim(const Array<T>& a, int i); // -> referTo
   void referToDim(const Array<T>& a, uint i, uint j);
   void referToDim(const Array<T>& a, uint i, uint j, uint k);
-  void takeOver(Array<T>& a);  //a becomes a reference to its previously owned memory!
+  void takeOver(Array<T>& a);  //a becomes a reference to its previously owned memory! (not for inline a)
   void swap(Array<T>& a);      //the two arrays swap their contents!
   void setGrid(uint dim, T lo, T hi, uint steps);
   
@@ -294,6 +433,7 @@ template<class T> struct Array : std::vector<T> {
   void anticipateMEM(uint Mforce) { resizeMEM(N, true, Mforce); if(!nd) nd=1; }
   void freeMEM();
   void resetD();
+  bool isInline() const { return ArrayInline<T>::N && (char*)p>=(char*)this && (char*)p<(char*)(this+1); } ///< p is the own inline buffer
 //  void init();
 };
 
@@ -333,8 +473,11 @@ template<class T> Array<T> operator%(const Array<T>& y, const Array<T>& z); //in
 template<class T> Array<T> operator*(const Array<T>& y, const Array<T>& z); //inner product
 template<class T> Array<T> operator*(const Array<T>& y, T z);
 template<class T> Array<T> operator*(T y, const Array<T>& z);
+template<class T> Array<T> operator*(Array<T>&& y, T z); //(the rvalue versions update and return the temporary y)
+template<class T> Array<T> operator*(T y, Array<T>&& z);
 template<class T> Array<T> operator/(int mustBeOne, const Array<T>& z_tobeinverted);
 template<class T> Array<T> operator/(const Array<T>& y, T z);
+template<class T> Array<T> operator/(Array<T>&& y, T z);
 template<class T> Array<T> operator/(const Array<T>& y, const Array<T>& z); //element-wise devision
 template<class T> Array<T> operator|(const Array<T>& A, const Array<T>& B); //A^-1 B
 template<class T> Array<T> operator,(const Array<T>& y, const Array<T>& z); //concat
@@ -370,7 +513,9 @@ UpdateOperator(%=)
 #define BinaryOperator( op, updateOp)         \
   template<class T> Array<T> operator op(const Array<T>& y, const Array<T>& z); \
   template<class T> Array<T> operator op(T y, const Array<T>& z);  \
-  template<class T> Array<T> operator op(const Array<T>& y, T z)
+  template<class T> Array<T> operator op(const Array<T>& y, T z); \
+  template<class T> Array<T> operator op(Array<T>&& y, const Array<T>& z); \
+  template<class T> Array<T> operator op(Array<T>&& y, T z)
 BinaryOperator(+ , +=);
 BinaryOperator(- , -=);
 //BinaryOperator(% , *=);
@@ -906,6 +1051,7 @@ struct RowShifted : SpecialArray {
   arr At_x(const arr& x);
   arr A_x(const arr& x);
   arr At();
+  arr Ainv_b_sym(const arr& b);
 };
 
 inline RowShifted* castRowShifted(arr& X) {
@@ -1004,6 +1150,7 @@ template<class vert, class edge> void graphDelete(rai::Array<vert*>& V, rai::Arr
 //
 
 #include <vector>
+#include <atomic>
 
 template<class T> rai::Array<T> conv_stdvec2arr(const std::vector<T>& v) {
   return rai::Array<T>(&v.front(), v.size());
@@ -46,7 +46,7 @@ template<class T> int rai::Array<T>::sizeT=-1;
 //***** constructors
 
 /// standard constructor -- this becomes an empty array
-template<class T> rai::Array<T>::Array():d(&d0) {
+template<class T> rai::Array<T>::Array():vec_type(ArrayAllocator<T>(ArrayInline<T>::inlineStorage())), d(&d0) {
   reference=false;
   if(sizeT==-1) sizeT=sizeof(T);
   if(memMove==(char)-1) {
@@ -72,6 +72,9 @@ template<class T> rai::Array<T>::Array():d(&d0) {
 /// copy constructor
 template<class T> rai::Array<T>::Array(const rai::Array<T>& a):Array() { operator=(a); }
 
+/// move constructor
+template<class T> rai::Array<T>::Array(rai::Array<T>&& a):Array() { operator=(std::move(a)); }
+
 /// constructor with resize
 template<class T> rai::Array<T>::Array(uint i):Array() { resize(i); }
 
@@ -414,7 +417,20 @@ template<class T> void rai::Array<T>::freeMEM() {
 template<class T> void rai::Array<T>::resizeMEM(uint n, bool copy, int Mforce) {
   if(n==N) return;
   CHECK(!reference, "resize of a reference (e.g. subarray) is not allowed! (only a resize without changing memory size)");
-  vec_type::resize(n);
+  if(n<=ArrayInline<T>::N && !vec_type::capacity()) {
+    vec_type::reserve(ArrayInline<T>::N); //the inline buffer (no heap), the full capacity right away
+    vec_type::resize(n);
+  } else if(n>vec_type::capacity()) {
+    globalMemoryAllocations++;
+    if(ArrayArena::request(this)) { //a local within an ArrayArena scope
+      try { vec_type::resize(n); } catch(...) { ArrayArena::endRequest(); throw; }
+      ArrayArena::endRequest();
+    } else {
+      vec_type::resize(n);
+    }
+  } else {
+    vec_type::resize(n);
+  }
   p = vec_type::data();
   N = n;
 }
@@ -423,11 +439,12 @@ template<class T> void rai::Array<T>::resizeMEM(uint n, bool copy, int Mforce) {
 template<class T> void rai::Array<T>::freeMEM() {
   if(!reference) {
     vec_type::clear();
-  } else {
-    vec_type::_M_impl._M_start = NULL;
-    vec_type::_M_impl._M_finish = NULL;
-    vec_type::_M_impl._M_end_of_storage = NULL;
+    //release the buffer (also the inline one), as the referTo methods overwrite the pointers
+    if(vec_type::_M_impl._M_start) vec_type::_M_deallocate(vec_type::_M_impl._M_start, vec_type::capacity());
   }
+  vec_type::_M_impl._M_start = NULL;
+  vec_type::_M_impl._M_finish = NULL;
+  vec_type::_M_impl._M_end_of_storage = NULL;
   if(d && d!=&d0) { delete[] d; d=NULL; }
   p=NULL;
   M=N=nd=d0=d1=d2=0;
@@ -1237,6 +1254,7 @@ template<class T> rai::Array<T>& rai::Array<T>::operator=(const rai::Array<T>& a
   //if(a.temp){ takeOver(*((rai::Array<T>*)&a)); return *this; }
   resizeAs(a);
   uint i;
+  if(N) globalMemoryCopies++;
   if(memMove) memmove(p, a.p, sizeT*N);
   else for(i=0; i<N; i++) p[i]=a.p[i];
   if(special) { delete special; special=NULL; }
@@ -1248,6 +1266,30 @@ template<class T> rai::Array<T>& rai::Array<T>::operator=(const rai::Array<T>& a
   return *this;
 }
 
+/** @brief move operator: takes over the buffer of a, which becomes empty. Falls back to the copy operator when the
+  buffer can't change owner: a's inline buffer, arena memory (unless this is itself a local of the current ArrayArena
+  scope), references (also as target: assigning to a subarray writes into it) and special arrays */
+template<class T> rai::Array<T>& rai::Array<T>::operator=(rai::Array<T>&& a) {
+  CHECK(this!=&a, "never do this!!!");
+  ArrayInlineBuffer *store = a.inlineStorage();
+  if(reference || special || a.reference || a.special || !a.p
+      || (store && (char*)a.p==store->buf)
+      || (ArrayArena::owns(a.p) && !ArrayArena::inScope(this))) return operator=((const Array<T>&)a);
+  freeMEM(); //release the own buffer
+  //take over a's buffer and dimensions
+  vec_type::_M_impl._M_start = a.vec_type::_M_impl._M_start;
+  vec_type::_M_impl._M_finish = a.vec_type::_M_impl._M_finish;
+  vec_type::_M_impl._M_end_of_storage = a.vec_type::_M_impl._M_end_of_storage;
+  p=a.p; N=a.N; nd=a.nd; d0=a.d0; d1=a.d1; d2=a.d2;
+  if(a.d!=&a.d0) { d=a.d; a.d=&a.d0; }
+  a.vec_type::_M_impl._M_start = NULL;
+  a.vec_type::_M_impl._M_finish = NULL;
+  a.vec_type::_M_impl._M_end_of_storage = NULL;
+  a.p=NULL;
+  a.N=a.nd=a.d0=a.d1=a.d2=0;
+  return *this;
+}
+
 /// copy operator
 template<class T> rai::Array<T>& rai::Array<T>::operator=(const std::vector<T>& a) {
   setCarray(&a.front(), a.size());
@@ -1600,16 +1642,12 @@ template<class T> void rai::Array<T>::referToDim(const rai::Array<T>& a, uint i,
 
 /** @brief takes over the memory buffer from a; afterwards, this is a
   proper array with own memory and a is only a reference on the
-  memory */
+  memory. An inline buffer can't change owner (it lives within a) */
 template<class T> void rai::Array<T>::takeOver(rai::Array<T>& a) {
-  freeMEM();
-  memMove=a.memMove;
-  N=a.N; nd=a.nd; d0=a.d0; d1=a.d1; d2=a.d2;
-  p=a.p;
-  M=a.M;
-  a.reference=true;
-  a.M=0;
-  HALT("vec not done yet");
+  CHECK(!a.reference, "can't take over the memory of a reference");
+  CHECK(!a.isInline(), "can't take over an inline buffer -- copy small arrays instead");
+  operator=(std::move(a)); //(copies arena memory and special arrays)
+  a.referTo(*this);
 }
 
 template<class T> void rai::Array<T>::swap(Array<T>& a) {
@@ -2250,12 +2288,13 @@ template<class T> T maxDiff(const rai::Array<T>& v, const rai::Array<T>& w, uint
   CHECK_EQ(v.N,w.N,
            "maxDiff on different array dimensions (" <<v.N <<", " <<w.N <<")");
   T d, t(0);
-  if(!im)
+  if(!im) {
+    if(v.N>=rai::simdMinN && rai::simd_maxDiff(t, v.p, w.p, v.N)) return t;
     for(uint i=v.N; i--;) {
       d=(T)::fabs((double)(v.p[i]-w.p[i]));
       if(d>t) t=d;
     }
-  else {
+  } else {
     *im=0;
     for(uint i=v.N; i--;) { d=(T)::fabs((double)(v.p[i]-w.p[i])); if(d>t) { t=d; *im=i; } }
   }
@@ -2437,6 +2476,7 @@ template<class T> T sumOfAbs(const rai::Array<T>& v) {
 /// \f$\sum_i x_i^2\f$
 template<class T> T sumOfSqr(const rai::Array<T>& v) {
   T t(0);
+  if(v.N>=rai::simdMinN && rai::simd_sumOfSqr(t, v.p, v.N)) return t;
   for(uint i=v.N; i--; t+=v.p[i]*v.p[i]) {};
   return t;
 }
@@ -2750,6 +2790,7 @@ T scalarProduct(const rai::Array<T>& v, const rai::Array<T>& w) {
   if(!v.special && !w.special) {
     CHECK_EQ(v.N,w.N,
              "scalar product on different array dimensions (" <<v.N <<", " <<w.N <<")");
+    if(v.N>=rai::simdMinN && rai::simd_scalarProduct(t, v.p, w.p, v.N)) return t;
     for(uint i=v.N; i--; t+=v.p[i]*w.p[i]);
   } else {
     if(isSparseVector(v) && isSparseVector(w)) {
@@ -3481,11 +3522,17 @@ template<class T> Array<T> operator*(const Array<T>& y, const Array<T>& z) { Arr
 template<class T> Array<T> operator*(const Array<T>& y, T z) {             Array<T> x(y); x*=z; return x; }
 /// scalar multiplication
 template<class T> Array<T> operator*(T y, const Array<T>& z) {             Array<T> x(z); x*=y; return x; }
+/// scalar multiplication of a temporary: reuses its buffer (unless it is a reference, e.g. a subarray)
+template<class T> Array<T> operator*(Array<T>&& y, T z) {  if(y.reference || y.special) return (const Array<T>&)y*z;  y*=z; return std::move(y); }
+/// scalar multiplication of a temporary
+template<class T> Array<T> operator*(T y, Array<T>&& z) {  if(z.reference || z.special) return y*(const Array<T>&)z;  z*=y; return std::move(z); }
 
 /// inverse
 template<class T> Array<T> operator/(int y, const Array<T>& z) {  Array<T> x=inverse(z); CHECK_EQ(y,1,""); return x; }
 /// scalar division
 template<class T> Array<T> operator/(const Array<T>& y, T z) {             Array<T> x(y); x/=z; return x; }
+/// scalar division of a temporary
+template<class T> Array<T> operator/(Array<T>&& y, T z) {  if(y.reference || y.special) return (const Array<T>&)y/z;  y/=z; return std::move(y); }
 /// element-wise division
 template<class T> Array<T> operator/(const Array<T>& y, const Array<T>& z) { Array<T> x(y); x/=z; return x; }
 
@@ -3501,9 +3548,10 @@ template<class T> Array<T>& operator<<(Array<T>& x, const Array<T>& y) { x.appen
 /// index-wise (elem-wise) product (x_i = y_i z_i   or  X_{ij} = y_i Z_{ij}  or  X_{ijk} = Y_{ij} Z_{jk}   etc)
 template<class T> Array<T> operator%(const Array<T>& y, const Array<T>& z) { Array<T> x; indexWiseProduct(x, y, z); return x; }
 
-#define UpdateOperator( op )        \
+#define UpdateOperator( op, simdOp )        \
   template<class T> Array<T>& operator op (Array<T>& x, const Array<T>& y){ \
     CHECK_EQ(x.N,y.N, "binary operator on different array dimensions (" <<x.N <<", " <<y.N <<")"); \
+    if(x.N>=rai::simdMinN && rai::simd_update(simdOp, x.p, y.p, x.N)) return x; \
     T *xp=x.p, *xstop=xp+x.N;              \
     const T *yp=y.p;              \
     for(; xp!=xstop; xp++, yp++) *xp op *yp;       \
@@ -3511,37 +3559,38 @@ template<class T> Array<T> operator%(const Array<T>& y, const Array<T>& z) { Arr
   }                 \
   \
   template<class T> Array<T>& operator op (Array<T>& x, T y ){ \
+    if(x.N>=rai::simdMinN && rai::simd_updateScalar(simdOp, x.p, y, x.N)) return x; \
     T *xp=x.p, *xstop=xp+x.N;              \
     for(; xp!=xstop; xp++) *xp op y;        \
     return x;           \
   } \
   \
-  template<class T> void operator op (Array<T>&& x, const Array<T>& y){ \
-    CHECK_EQ(x.N,y.N, "binary operator on different array dimensions (" <<x.N <<", " <<y.N <<")"); \
-    T *xp=x.p, *xstop=xp+x.N;              \
-    const T *yp=y.p;              \
-    for(; xp!=xstop; xp++, yp++) *xp op *yp;       \
-  }                 \
+  template<class T> void operator op (Array<T>&& x, const Array<T>& y){ (Array<T>&)x op y; } \
   \
-  template<class T> void operator op (Array<T>&& x, T y ){ \
-    T *xp=x.p, *xstop=xp+x.N;              \
-    for(; xp!=xstop; xp++) *xp op y;        \
-  }
-
-UpdateOperator(|=)
-UpdateOperator(^=)
-UpdateOperator(&=)
-UpdateOperator(+=)
-UpdateOperator(-=)
-UpdateOperator(*=)
-UpdateOperator(/=)
-UpdateOperator(%=)
+  template<class T> void operator op (Array<T>&& x, T y ){ (Array<T>&)x op y; }
+
+UpdateOperator(|=, rai::SIMD_none)
+UpdateOperator(^=, rai::SIMD_none)
+UpdateOperator(&=, rai::SIMD_none)
+UpdateOperator(+=, rai::SIMD_add)
+UpdateOperator(-=, rai::SIMD_sub)
+UpdateOperator(*=, rai::SIMD_mul)
+UpdateOperator(/=, rai::SIMD_div)
+UpdateOperator(%=, rai::SIMD_none)
 #undef UpdateOperator
 
 #define BinaryOperator( op, updateOp)         \
   template<class T> Array<T> operator op(const Array<T>& y, const Array<T>& z){ Array<T> x(y); x updateOp z; return x; } \
   template<class T> Array<T> operator op(T y, const Array<T>& z){               Array<T> x; x.resizeAs(z); x=y; x updateOp z; return x; } \
-  template<class T> Array<T> operator op(const Array<T>& y, T z){               Array<T> x(y); x updateOp z; return x; }
+  template<class T> Array<T> operator op(const Array<T>& y, T z){               Array<T> x(y); x updateOp z; return x; } \
+  template<class T> Array<T> operator op(Array<T>&& y, const Array<T>& z){ \
+    if(y.reference || y.special) return (const Array<T>&)y op z; /*don't write into a subarray*/ \
+    y updateOp z; return std::move(y); \
+  } \
+  template<class T> Array<T> operator op(Array<T>&& y, T z){ \
+    if(y.reference || y.special) return (const Array<T>&)y op z; \
+    y updateOp z; return std::move(y); \
+  }
 
 BinaryOperator(+ , +=);
 BinaryOperator(- , -=);
@@ -3625,6 +3674,18 @@ inline double sign(double x) {  return (x > 0) - (x < 0); }
     return x;         \
   }
 
+/// the same, with the SIMD kernel for large double and float Arrays
+#define UnaryFunctionSimd( func, simdOp )         \
+  template<class T>           \
+  rai::Array<T> func (const rai::Array<T>& y){    \
+    rai::Array<T> x;           \
+    x.resizeAs(y);         \
+    if(x.N>=rai::simdMinN && rai::simd_unary(simdOp, x.p, y.p, x.N)) return x; \
+    T *xp=x.p, *xstop=xp+x.N, *yp=y.p;            \
+    for(; xp!=xstop; xp++, yp++) *xp = (T)::func( (double) *yp );  \
+    return x;         \
+  }
+
 // trigonometric functions
 UnaryFunction(acos);
 UnaryFunction(asin);
@@ -3642,23 +3703,24 @@ UnaryFunction(asinh);
 UnaryFunction(atanh);
 
 // exponential and logarithmic functions
-UnaryFunction(exp);
+UnaryFunctionSimd(exp, rai::SIMD_exp);
 UnaryFunction(log);
 UnaryFunction(log10);
 
 //roots
-UnaryFunction(sqrt);
+UnaryFunctionSimd(sqrt, rai::SIMD_sqrt);
 UnaryFunction(cbrt);
 
 // nearest integer and absolute value
 UnaryFunction(ceil);
-UnaryFunction(fabs);
+UnaryFunctionSimd(fabs, rai::SIMD_fabs);
 UnaryFunction(floor);
-UnaryFunction(sigm);
+UnaryFunctionSimd(sigm, rai::SIMD_sigm);
 
 UnaryFunction(sign);
 
 #undef UnaryFunction
+#undef UnaryFunctionSimd
 
 //---------- binary functions
 
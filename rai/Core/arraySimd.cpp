@@ -0,0 +1,205 @@
+/*  ------------------------------------------------------------------
+    Copyright (c) 2017 Marc Toussaint
+    email: marc.toussaint@informatik.uni-stuttgart.de
+
+    This code is distributed under the MIT License.
+    Please see <root-path>/LICENSE for details.
+    --------------------------------------------------------------  */
+
+#include "array.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#  define RAI_SIMD
+#  include <immintrin.h>
+#endif
+
+namespace rai {
+
+#ifdef RAI_SIMD
+
+static int simdDetect() {
+  __builtin_cpu_init(); //(we run in a static initializer)
+  if(__builtin_cpu_supports("avx512f")) return 2;
+  if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return 1;
+  return 0;
+}
+const int simdSupported=simdDetect();
+
+//the kernels are compiled once per instruction set: the target pragma enables it for all functions of the region,
+//including the instantiations of the templates defined therein
+
+#define AI __attribute__((always_inline)) inline
+
+template<int op, class T> inline T applyScalar(T a, T b) {
+  if(op==SIMD_add) return a+b;
+  if(op==SIMD_sub) return a-b;
+  if(op==SIMD_mul) return a*b;
+  return a/b;
+}
+
+#pragma GCC push_options
+#pragma GCC target("avx2,fma")
+namespace avx2 {
+
+struct D {
+  typedef double T;  typedef __m256d V;  static const uint n=4;
+  AI static V load(const T *p) { return _mm256_loadu_pd(p); }
+  AI static void store(T *p, V a) { _mm256_storeu_pd(p, a); }
+  AI static V set1(T a) { return _mm256_set1_pd(a); }
+  AI static V zero() { return _mm256_setzero_pd(); }
+  AI static V add(V a, V b) { return _mm256_add_pd(a, b); }
+  AI static V sub(V a, V b) { return _mm256_sub_pd(a, b); }
+  AI static V mul(V a, V b) { return _mm256_mul_pd(a, b); }
+  AI static V div(V a, V b) { return _mm256_div_pd(a, b); }
+  AI static V sqrt(V a) { return _mm256_sqrt_pd(a); }
+  AI static V abs(V a) { return _mm256_andnot_pd(_mm256_set1_pd(-0.), a); }
+  AI static V max(V a, V b) { return _mm256_max_pd(a, b); } //b if either is NaN
+  AI static V fmadd(V a, V b, V c) { return _mm256_fmadd_pd(a, b, c); }  ///< a*b+c
+  AI static V fnmadd(V a, V b, V c) { return _mm256_fnmadd_pd(a, b, c); } ///< c-a*b
+  AI static T hsum(V a) { T b[n]; store(b, a); return (b[0]+b[1])+(b[2]+b[3]); }
+  AI static T hmax(V a) { T b[n]; store(b, a); T m=b[0]; for(uint i=1; i<n; i++) if(b[i]>m) m=b[i]; return m; }
+  AI static V pow2(V t) { return _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_add_epi64(_mm256_castpd_si256(t), _mm256_set1_epi64x(1023)), 52)); } ///< 2^k for t=k+1.5*2^52
+  AI static bool within(V a, T lo, T hi) { return _mm256_movemask_pd(_mm256_and_pd(_mm256_cmp_pd(a, set1(lo), _CMP_GE_OQ), _mm256_cmp_pd(a, set1(hi), _CMP_LE_OQ)))==0xf; }
+};
+
+struct F {
+  typedef float T;  typedef __m256 V;  static const uint n=8;
+  AI static V load(const T *p) { return _mm256_loadu_ps(p); }
+  AI static void store(T *p, V a) { _mm256_storeu_ps(p, a); }
+  AI static V set1(T a) { return _mm256_set1_ps(a); }
+  AI static V zero() { return _mm256_setzero_ps(); }
+  AI static V add(V a, V b) { return _mm256_add_ps(a, b); }
+  AI static V sub(V a, V b) { return _mm256_sub_ps(a, b); }
+  AI static V mul(V a, V b) { return _mm256_mul_ps(a, b); }
+  AI static V div(V a, V b) { return _mm256_div_ps(a, b); }
+  AI static V sqrt(V a) { return _mm256_sqrt_ps(a); }
+  AI static V abs(V a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.f), a); }
+  AI static V max(V a, V b) { return _mm256_max_ps(a, b); }
+  AI static V fmadd(V a, V b, V c) { return _mm256_fmadd_ps(a, b, c); }
+  AI static T hsum(V a) { T b[n]; store(b, a); return ((b[0]+b[1])+(b[2]+b[3]))+((b[4]+b[5])+(b[6]+b[7])); }
+  AI static T hmax(V a) { T b[n]; store(b, a); T m=b[0]; for(uint i=1; i<n; i++) if(b[i]>m) m=b[i]; return m; }
+};
+
+#include "arraySimd.tpp"
+
+} //namespace avx2
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"       //(false positives of gcc's own avx512 intrinsics in debug builds)
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+namespace avx512 {
+
+struct D {
+  typedef double T;  typedef __m512d V;  static const uint n=8;
+  AI static V load(const T *p) { return _mm512_loadu_pd(p); }
+  AI static void store(T *p, V a) { _mm512_storeu_pd(p, a); }
+  AI static V set1(T a) { return _mm512_set1_pd(a); }
+  AI static V zero() { return _mm512_setzero_pd(); }
+  AI static V add(V a, V b) { return _mm512_add_pd(a, b); }
+  AI static V sub(V a, V b) { return _mm512_sub_pd(a, b); }
+  AI static V mul(V a, V b) { return _mm512_mul_pd(a, b); }
+  AI static V div(V a, V b) { return _mm512_div_pd(a, b); }
+  AI static V sqrt(V a) { return _mm512_sqrt_pd(a); }
+  AI static V abs(V a) { return _mm512_abs_pd(a); }
+  AI static V max(V a, V b) { return _mm512_max_pd(a, b); }
+  AI static V fmadd(V a, V b, V c) { return _mm512_fmadd_pd(a, b, c); }
+  AI static V fnmadd(V a, V b, V c) { return _mm512_fnmadd_pd(a, b, c); }
+  AI static T hsum(V a) { return _mm512_reduce_add_pd(a); }
+  AI static T hmax(V a) { return _mm512_reduce_max_pd(a); }
+  AI static V pow2(V t) { return _mm512_castsi512_pd(_mm512_slli_epi64(_mm512_add_epi64(_mm512_castpd_si512(t), _mm512_set1_epi64(1023)), 52)); }
+  AI static bool within(V a, T lo, T hi) { return (_mm512_cmp_pd_mask(a, set1(lo), _CMP_GE_OQ) & _mm512_cmp_pd_mask(a, set1(hi), _CMP_LE_OQ))==0xff; }
+};
+
+struct F {
+  typedef float T;  typedef __m512 V;  static const uint n=16;
+  AI static V load(const T *p) { return _mm512_loadu_ps(p); }
+  AI static void store(T *p, V a) { _mm512_storeu_ps(p, a); }
+  AI static V set1(T a) { return _mm512_set1_ps(a); }
+  AI static V zero() { return _mm512_setzero_ps(); }
+  AI static V add(V a, V b) { return _mm512_add_ps(a, b); }
+  AI static V sub(V a, V b) { return _mm512_sub_ps(a, b); }
+  AI static V mul(V a, V b) { return _mm512_mul_ps(a, b); }
+  AI static V div(V a, V b) { return _mm512_div_ps(a, b); }
+  AI static V sqrt(V a) { return _mm512_sqrt_ps(a); }
+  AI static V abs(V a) { return _mm512_abs_ps(a); }
+  AI static V max(V a, V b) { return _mm512_max_ps(a, b); }
+  AI static V fmadd(V a, V b, V c) { return _mm512_fmadd_ps(a, b, c); }
+  AI static T hsum(V a) { return _mm512_reduce_add_ps(a); }
+  AI static T hmax(V a) { return _mm512_reduce_max_ps(a); }
+};
+
+#include "arraySimd.tpp"
+
+} //namespace avx512
+#pragma GCC diagnostic pop
+#pragma GCC pop_options
+
+#undef AI
+
+#define SIMD_DISPATCH(kernel, S, ...) \
+  if(simdLevel>=2) return avx512::kernel<avx512::S>(__VA_ARGS__); \
+  if(simdLevel==1) return avx2::kernel<avx2::S>(__VA_ARGS__); \
+  return false;
+
+#define SIMD_DISPATCH_VALUE(kernel, S, value, ...) \
+  if(simdLevel>=2) { value=avx512::kernel<avx512::S>(__VA_ARGS__); return true; } \
+  if(simdLevel==1) { value=avx2::kernel<avx2::S>(__VA_ARGS__); return true; } \
+  return false;
+
+bool simd_update(SimdOp op, double *x, const double *y, uint n) { SIMD_DISPATCH(update, D, op, x, y, n) }
+bool simd_update(SimdOp op, float *x, const float *y, uint n) { SIMD_DISPATCH(update, F, op, x, y, n) }
+bool simd_updateScalar(SimdOp op, double *x, double y, uint n) { SIMD_DISPATCH(updateScalar, D, op, x, y, n) }
+bool simd_updateScalar(SimdOp op, float *x, float y, uint n) { SIMD_DISPATCH(updateScalar, F, op, x, y, n) }
+
+bool simd_unary(SimdOp op, double *x, const double *y, uint n) { SIMD_DISPATCH(unaryDouble, D, op, x, y, n) }
+
+bool simd_unary(SimdOp op, float *x, const float *y, uint n) {
+  if(op==SIMD_exp || op==SIMD_sigm) { //in double precision, as the scalar loop
+    if(!simdLevel) return false;
+    double buf[256];
+    for(uint i=0; i<n; i+=256) {
+      uint m = n-i<256 ? n-i : 256;
+      for(uint j=0; j<m; j++) buf[j]=y[i+j];
+      simd_unary(op, buf, buf, m);
+      for(uint j=0; j<m; j++) x[i+j]=(float)buf[j];
+    }
+    return true;
+  }
+  SIMD_DISPATCH(unary, F, op, x, y, n)
+}
+
+bool simd_sumOfSqr(double& s, const double *x, uint n) { SIMD_DISPATCH_VALUE(sumOfSqr, D, s, x, n) }
+bool simd_sumOfSqr(float& s, const float *x, uint n) { SIMD_DISPATCH_VALUE(sumOfSqr, F, s, x, n) }
+bool simd_scalarProduct(double& s, const double *x, const double *y, uint n) { SIMD_DISPATCH_VALUE(scalarProduct, D, s, x, y, n) }
+bool simd_scalarProduct(float& s, const float *x, const float *y, uint n) { SIMD_DISPATCH_VALUE(scalarProduct, F, s, x, y, n) }
+bool simd_maxDiff(double& m, const double *x, const double *y, uint n) { SIMD_DISPATCH_VALUE(maxDiff, D, m, x, y, n) }
+bool simd_maxDiff(float& m, const float *x, const float *y, uint n) { SIMD_DISPATCH_VALUE(maxDiff, F, m, x, y, n) }
+
+#undef SIMD_DISPATCH
+#undef SIMD_DISPATCH_VALUE
+
+#else //RAI_SIMD
+
+const int simdSupported=0;
+
+bool simd_update(SimdOp op, double *x, const double *y, uint n) { return false; }
+bool simd_update(SimdOp op, float *x, const float *y, uint n) { return false; }
+bool simd_updateScalar(SimdOp op, double *x, double y, uint n) { return false; }
+bool simd_updateScalar(SimdOp op, float *x, float y, uint n) { return false; }
+bool simd_unary(SimdOp op, double *x, const double *y, uint n) { return false; }
+bool simd_unary(SimdOp op, float *x, const float *y, uint n) { return false; }
+bool simd_sumOfSqr(double& s, const double *x, uint n) { return false; }
+bool simd_sumOfSqr(float& s, const float *x, uint n) { return false; }
+bool simd_scalarProduct(double& s, const double *x, const double *y, uint n) { return false; }
+bool simd_scalarProduct(float& s, const float *x, const float *y, uint n) { return false; }
+bool simd_maxDiff(double& m, const double *x, const double *y, uint n) { return false; }
+bool simd_maxDiff(float& m, const float *x, const float *y, uint n) { return false; }
+
+#endif //RAI_SIMD
+
+int simdLevel=simdSupported;
+
+} //namespace
@@ -0,0 +1,143 @@
+/*  ------------------------------------------------------------------
+    Copyright (c) 2017 Marc Toussaint
+    email: marc.toussaint@informatik.uni-stuttgart.de
+
+    This code is distributed under the MIT License.
+    Please see <root-path>/LICENSE for details.
+    --------------------------------------------------------------  */
+
+//the kernels of arraySimd.cpp, included there once per instruction set (within its target region and namespace) and
+//written against the traits S of one vector type: S::V holds S::n elements of type S::T
+
+template<class S, int op> AI typename S::V apply(typename S::V a, typename S::V b) {
+  if(op==SIMD_add) return S::add(a, b);
+  if(op==SIMD_sub) return S::sub(a, b);
+  if(op==SIMD_mul) return S::mul(a, b);
+  return S::div(a, b);
+}
+
+template<class S, int op> void updateLoop(typename S::T *x, const typename S::T *y, uint n) {
+  uint i=0;
+  for(; i+S::n<=n; i+=S::n) S::store(x+i, apply<S, op>(S::load(x+i), S::load(y+i)));
+  for(; i<n; i++) x[i] = applyScalar<op>(x[i], y[i]);
+}
+
+template<class S, int op> void updateScalarLoop(typename S::T *x, typename S::T y, uint n) {
+  typename S::V b=S::set1(y);
+  uint i=0;
+  for(; i+S::n<=n; i+=S::n) S::store(x+i, apply<S, op>(S::load(x+i), b));
+  for(; i<n; i++) x[i] = applyScalar<op>(x[i], y);
+}
+
+template<class S> bool update(SimdOp op, typename S::T *x, const typename S::T *y, uint n) {
+  switch(op) {
+    case SIMD_add: updateLoop<S, SIMD_add>(x, y, n); return true;
+    case SIMD_sub: updateLoop<S, SIMD_sub>(x, y, n); return true;
+    case SIMD_mul: updateLoop<S, SIMD_mul>(x, y, n); return true;
+    case SIMD_div: updateLoop<S, SIMD_div>(x, y, n); return true;
+    default: return false;
+  }
+}
+
+template<class S> bool updateScalar(SimdOp op, typename S::T *x, typename S::T y, uint n) {
+  switch(op) {
+    case SIMD_add: updateScalarLoop<S, SIMD_add>(x, y, n); return true;
+    case SIMD_sub: updateScalarLoop<S, SIMD_sub>(x, y, n); return true;
+    case SIMD_mul: updateScalarLoop<S, SIMD_mul>(x, y, n); return true;
+    case SIMD_div: updateScalarLoop<S, SIMD_div>(x, y, n); return true;
+    default: return false;
+  }
+}
+
+/// sqrt and fabs (exp and sigm: see exp)
+template<class S> bool unary(SimdOp op, typename S::T *x, const typename S::T *y, uint n) {
+  uint i=0;
+  if(op==SIMD_sqrt) {
+    for(; i+S::n<=n; i+=S::n) S::store(x+i, S::sqrt(S::load(y+i)));
+    for(; i<n; i++) x[i] = ::sqrt(y[i]);
+    return true;
+  }
+  if(op==SIMD_fabs) {
+    for(; i+S::n<=n; i+=S::n) S::store(x+i, S::abs(S::load(y+i)));
+    for(; i<n; i++) x[i] = ::fabs(y[i]);
+    return true;
+  }
+  return false;
+}
+
+/** x[i] = exp(y[i]) (or sigm(y[i]) = 1/(1+exp(-y[i]))) as 2^k exp(r), with k=round(y/ln2), r=y-k ln2 (ln2 in two parts,
+  the first one exact in k ln2) and the Taylor series of exp(r), |r|<=ln2/2, to degree 13 -- within about 1 ulp. Vectors
+  with arguments outside [-708, 708] (where 2^k isn't a normal double) or NaNs are passed to ::exp. Doubles only */
+template<class S, bool sigm> void exp(double *x, const double *y, uint n) {
+  typedef typename S::V V;
+  const V log2e=S::set1(1.44269504088896338700e+00), ln2hi=S::set1(6.93147180369123816490e-01), ln2lo=S::set1(1.90821492927058770002e-10);
+  const V magic=S::set1(6755399441055744.); //1.5*2^52: adding it rounds to an integer, which ends up in the low mantissa bits
+  const V one=S::set1(1.);
+  static const double c[14] = { 1., 1., 1./2, 1./6, 1./24, 1./120, 1./720, 1./5040, 1./40320, 1./362880, 1./3628800,
+                                1./39916800, 1./479001600, 1./6227020800. };
+  uint i=0;
+  for(; i+S::n<=n; i+=S::n) {
+    V a=S::load(y+i);
+    if(sigm) a=S::sub(S::zero(), a);
+    if(!S::within(a, -708., 708.)) {
+      for(uint j=i; j<i+S::n; j++) x[j] = sigm ? ::sigm(y[j]) : ::exp(y[j]);
+      continue;
+    }
+    V t=S::fmadd(a, log2e, magic);
+    V k=S::sub(t, magic);
+    V r=S::fnmadd(k, ln2hi, a);
+    r=S::fnmadd(k, ln2lo, r);
+    V p=S::set1(c[13]);
+    for(int j=12; j>=0; j--) p=S::fmadd(p, r, S::set1(c[j]));
+    p=S::mul(p, S::pow2(t));
+    if(sigm) p=S::div(one, S::add(one, p));
+    S::store(x+i, p);
+  }
+  for(; i<n; i++) x[i] = sigm ? ::sigm(y[i]) : ::exp(y[i]);
+}
+
+/// all unary functions of double vectors
+template<class S> bool unaryDouble(SimdOp op, double *x, const double *y, uint n) {
+  if(op==SIMD_exp) { exp<S, false>(x, y, n); return true; }
+  if(op==SIMD_sigm) { exp<S, true>(x, y, n); return true; }
+  return unary<S>(op, x, y, n);
+}
+
+template<class S> typename S::T sumOfSqr(const typename S::T *x, uint n) {
+  typedef typename S::V V;
+  V s0=S::zero(), s1=S::zero(), s2=S::zero(), s3=S::zero(); //4 independent sums, to not wait for the latency of the adds
+  uint i=0;
+  for(; i+4*S::n<=n; i+=4*S::n) {
+    V a0=S::load(x+i), a1=S::load(x+i+S::n), a2=S::load(x+i+2*S::n), a3=S::load(x+i+3*S::n);
+    s0=S::fmadd(a0, a0, s0);  s1=S::fmadd(a1, a1, s1);  s2=S::fmadd(a2, a2, s2);  s3=S::fmadd(a3, a3, s3);
+  }
+  for(; i+S::n<=n; i+=S::n) { V a=S::load(x+i); s0=S::fmadd(a, a, s0); }
+  typename S::T s = S::hsum(S::add(S::add(s0, s1), S::add(s2, s3)));
+  for(; i<n; i++) s += x[i]*x[i];
+  return s;
+}
+
+template<class S> typename S::T scalarProduct(const typename S::T *x, const typename S::T *y, uint n) {
+  typedef typename S::V V;
+  V s0=S::zero(), s1=S::zero(), s2=S::zero(), s3=S::zero();
+  uint i=0;
+  for(; i+4*S::n<=n; i+=4*S::n) {
+    s0=S::fmadd(S::load(x+i), S::load(y+i), s0);
+    s1=S::fmadd(S::load(x+i+S::n), S::load(y+i+S::n), s1);
+    s2=S::fmadd(S::load(x+i+2*S::n), S::load(y+i+2*S::n), s2);
+    s3=S::fmadd(S::load(x+i+3*S::n), S::load(y+i+3*S::n), s3);
+  }
+  for(; i+S::n<=n; i+=S::n) s0=S::fmadd(S::load(x+i), S::load(y+i), s0);
+  typename S::T s = S::hsum(S::add(S::add(s0, s1), S::add(s2, s3)));
+  for(; i<n; i++) s += x[i]*y[i];
+  return s;
+}
+
+template<class S> typename S::T maxDiff(const typename S::T *x, const typename S::T *y, uint n) {
+  typename S::V m=S::zero();
+  uint i=0;
+  for(; i+S::n<=n; i+=S::n) m=S::max(S::abs(S::sub(S::load(x+i), S::load(y+i))), m); //(NaN differences are ignored, as in the scalar loop)
+  typename S::T t = S::hmax(m), d;
+  for(; i<n; i++) { d=::fabs(x[i]-y[i]); if(d>t) t=d; }
+  return t;
+}
@@ -748,6 +748,98 @@ void Thread::main() {
   event.setStatus(tsIsClosed);
 }
 
+//===========================================================================
+//
+// ThreadPool
+//
+
+struct ThreadPool_worker { ThreadPool *pool; uint worker; };
+
+void* ThreadPool_staticMain(void *_arg) {
+  ThreadPool_worker *arg = (ThreadPool_worker*)_arg;
+  arg->pool->workerMain(arg->worker);
+  delete arg;
+  return NULL;
+}
+
+ThreadPool::ThreadPool(uint _numThreads) : numThreads(_numThreads) {
+  if(!numThreads) numThreads=1;
+  int rc = pthread_cond_init(&cond, NULL);  if(rc) HALT("pthread failed with err " <<rc <<" '" <<strerror(rc) <<"'");
+  threads.resize(numThreads-1);
+  for(uint w=1; w<numThreads; w++) {
+    rc = pthread_create(&threads(w-1), NULL, ThreadPool_staticMain, new ThreadPool_worker({this, w}));
+    if(rc) HALT("pthread failed with err " <<rc <<" '" <<strerror(rc) <<"'");
+    pthread_setname_np(threads(w-1), STRING("pool" <<w));
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  mutex.lock();
+  quit=true;
+  pthread_cond_broadcast(&cond);
+  mutex.unlock();
+  for(pthread_t& th:threads) {
+    int rc = pthread_join(th, NULL);  if(rc) LOG(-1) <<"pthread_join failed with err " <<rc <<" '" <<strerror(rc) <<"'"; //(don't throw from a destructor)
+  }
+  int rc = pthread_cond_destroy(&cond);  if(rc) LOG(-1) <<"pthread failed with err " <<rc <<" '" <<strerror(rc) <<"'";
+}
+
+void ThreadPool::run(uint n, const std::function<void(uint i, uint worker)>& f) {
+  if(numThreads<=1 || n<=1) { //serial: no need to wake anybody
+    for(uint i=0; i<n; i++) f(i, 0);
+    return;
+  }
+  mutex.lock();
+  CHECK(!jobsN, "ThreadPool::run is not reentrant");
+  job = f;
+  jobsN=n; jobsNext=0; jobsDone=0;
+  error.clear();
+  revision++;
+  pthread_cond_broadcast(&cond);
+  work(0);
+  while(jobsDone<jobsN) {
+    int rc = pthread_cond_wait(&cond, &mutex.mutex);  if(rc) HALT("pthread failed with err " <<rc <<" '" <<strerror(rc) <<"'");
+  }
+  job = nullptr;
+  jobsN=jobsNext=jobsDone=0;
+  rai::String err = error;
+  mutex.unlock();
+  if(err.N) HALT("a ThreadPool job failed: " <<err);
+}
+
+void ThreadPool::workerMain(uint worker) {
+  mutex.lock();
+  uint seen=0;
+  for(;;) {
+    while(!quit && revision==seen) {
+      int rc = pthread_cond_wait(&cond, &mutex.mutex);  if(rc) HALT("pthread failed with err " <<rc <<" '" <<strerror(rc) <<"'");
+    }
+    if(quit) break;
+    seen=revision;
+    work(worker);
+  }
+  mutex.unlock();
+}
+
+void ThreadPool::work(uint worker) {
+  while(jobsNext<jobsN) {
+    uint i = jobsNext++;
+    mutex.unlock();
+    rai::String err;
+    try {
+      job(i, worker);
+    } catch(const std::exception& ex) {
+      err <<ex.what();
+    } catch(...) {
+      err <<"unknown exception";
+    }
+    mutex.lock();
+    if(err.N && !error.N) error = err;
+    jobsDone++;
+    if(jobsDone==jobsN) pthread_cond_broadcast(&cond);
+  }
+}
+
 //===========================================================================
 //
 // controlling threads
@@ -406,6 +406,33 @@ struct Thread {
   void main(); //this is the thread main - should be private!
 };
 
+//===========================================================================
+/**
+ * A fixed set of worker threads to evaluate independent jobs in parallel.
+ *
+ * run(n, f) calls f(i, worker) for all i=0..n-1 and returns when all jobs are done.
+ * The calling thread participates as worker 0, so f is called with worker<numThreads.
+ * An exception thrown in a job is re-thrown (as HALT) by run().
+ */
+struct ThreadPool : NonCopyable {
+  uint numThreads;              ///< total number of workers, including the caller of run()
+  rai::Array<pthread_t> threads; ///< the numThreads-1 pthreads
+  Mutex mutex;
+  pthread_cond_t cond;          ///< broadcasted on new jobs, on all jobs done, and on quit
+  std::function<void(uint, uint)> job;
+  uint jobsN=0, jobsNext=0, jobsDone=0, revision=0;
+  bool quit=false;
+  rai::String error;            ///< first error message thrown by a job
+
+  ThreadPool(uint _numThreads);
+  ~ThreadPool();
+
+  void run(uint n, const std::function<void(uint i, uint worker)>& f);
+
+  void workerMain(uint worker); //this is the pthread main - should be private!
+  void work(uint worker);       //process jobs until none is left (mutex is locked)
+};
+
 
 //===========================================================================
 //
@@ -340,6 +340,7 @@ REAL gjk_distance(
       use_seed = 0;
       simplex = & local_simplex;
    }
+   simplex->iterations = 0;
 
    if ( use_seed==0 ) {
       simplex->simplex1[0] = 0;    simplex->simplex2[0] = 0;
@@ -450,6 +451,7 @@ REAL gjk_distance(
      /* Now apply the G-test on this pair of points */
 
      INCREMENT_G_TEST_COUNTER;
+     simplex->iterations++;
 
      g_val = sqrd + maxv + minus_minv;
 
@@ -196,6 +196,8 @@ struct simplex_point {
 
      Alternatively, G/(x.x) is a relative error bound on the result.
   */
+  int iterations; /** number of main loop iterations (G-tests) of the last call --
+                     fewer when the call was seeded with a good simplex */
 };
 
 /** Even this algorithm has an epsilon (fudge) factor.  It basically indicates
@@ -54,6 +54,15 @@ void rai::Geom::read(const Graph &ats) {
   
   createMeshes();
   
+  if(ats.get(d, "sdf")) {
+    double band=.1;
+    ats.get(band, "sdfBand");
+    rai::String file;
+    ats.get(file, "sdfFile");
+    sdf = std::make_shared<DistanceFunction_SDF>();
+    sdf->bake(mesh, d, band, file.N?file.p:NULL);
+  }
+  
   //colored box?
   if(ats["coloredBox"]) {
     CHECK_EQ(mesh.V.d0, 8, "I need a box");
@@ -67,6 +76,15 @@ void rai::Geom::read(const Graph &ats) {
   }
 }
 
+std::shared_ptr<const rai::MeshBVH> rai::Geom::getBVH() {
+  static Mutex meshMutex;
+  {
+    auto lock = meshMutex();
+    if(!mesh.V.N) createMeshes();
+  }
+  return mesh.getBVH();
+}
+
 void rai::Geom::createMeshes() {
   //create mesh for basic shapes
   switch(type) {
@@ -10,6 +10,8 @@
 
 #include <Core/array.h>
 #include "mesh.h"
+#include "meshBVH.h"
+#include <memory>
 
 namespace rai {
 
@@ -24,6 +26,7 @@ struct Geom {
   Enum<ShapeType> type;
   arr size;
   Mesh mesh, sscCore;
+  std::shared_ptr<DistanceFunction_SDF> sdf; ///< optional, baked from the mesh (attributes sdf=<resolution>, sdfBand, sdfFile for the disk cache)
   
   Geom(GeomStore& _store);
   
@@ -31,6 +34,7 @@ struct Geom {
   
   void read(const Graph &ats);
   void createMeshes();
+  std::shared_ptr<const MeshBVH> getBVH(); ///< the BVH of the mesh (see Mesh::getBVH): keep the pointer while querying, a changed mesh gets a new one
   void glDraw(OpenGL&);
 };
 
@@ -7,6 +7,8 @@
     --------------------------------------------------------------  */
 
 #include "mesh.h"
+#include "meshBVH.h"
+#include <Core/thread.h>
 #include "qhull.h"
 
 
@@ -2238,6 +2240,237 @@ ScalarFunction DistanceFunction_SSBox = [](arr& g, arr& H, const arr& x) -> doub
   return d;
 };
 
+//===========================================================================
+
+/// the Voronoi region tests of Ericson, Real-Time Collision Detection, 5.1.5
+double closestPointOnTriangle(double *q, const double *p, const double *a, const double *b, const double *c) {
+  double ab[3], ac[3], ap[3], bp[3], cp[3], r[3];
+  for(uint i=0; i<3; i++) { ab[i]=b[i]-a[i]; ac[i]=c[i]-a[i]; ap[i]=p[i]-a[i]; bp[i]=p[i]-b[i]; cp[i]=p[i]-c[i]; }
+#define DOT(u, v) (u[0]*v[0]+u[1]*v[1]+u[2]*v[2])
+  double d1=DOT(ab, ap), d2=DOT(ac, ap);
+  double d3=DOT(ab, bp), d4=DOT(ac, bp);
+  double d5=DOT(ab, cp), d6=DOT(ac, cp);
+  double va=d3*d6-d5*d4, vb=d5*d2-d1*d6, vc=d1*d4-d3*d2;
+  if(d1<=0. && d2<=0.) { //vertex a
+    for(uint i=0; i<3; i++) r[i]=ap[i];
+  } else if(d3>=0. && d4<=d3) { //vertex b
+    for(uint i=0; i<3; i++) r[i]=bp[i];
+  } else if(d6>=0. && d5<=d6) { //vertex c
+    for(uint i=0; i<3; i++) r[i]=cp[i];
+  } else if(vc<=0. && d1>=0. && d3<=0.) { //edge ab
+    double v=d1/(d1-d3);
+    for(uint i=0; i<3; i++) r[i]=ap[i]-v*ab[i];
+  } else if(vb<=0. && d2>=0. && d6<=0.) { //edge ac
+    double w=d2/(d2-d6);
+    for(uint i=0; i<3; i++) r[i]=ap[i]-w*ac[i];
+  } else if(va<=0. && d4-d3>=0. && d5-d6>=0.) { //edge bc
+    double w=(d4-d3)/((d4-d3)+(d5-d6));
+    for(uint i=0; i<3; i++) r[i]=bp[i]-w*(c[i]-b[i]);
+  } else { //face
+    double den=1./(va+vb+vc), v=vb*den, w=vc*den;
+    for(uint i=0; i<3; i++) r[i]=ap[i]-v*ab[i]-w*ac[i];
+  }
+  if(q) for(uint i=0; i<3; i++) q[i]=p[i]-r[i];
+  return DOT(r, r);
+#undef DOT
+}
+
+DistanceFunction_SDF::DistanceFunction_SDF() {
+  t.setZero();
+  ScalarFunction::operator=([this](arr& g, arr& H, const arr& x)->double{ return f(g,H,x); });
+}
+
+DistanceFunction_SDF::DistanceFunction_SDF(const rai::Transformation& _t, const rai::Mesh& mesh, double _res, double _band, const char* cacheFile) : t(_t) {
+  ScalarFunction::operator=([this](arr& g, arr& H, const arr& x)->double{ return f(g,H,x); });
+  bake(mesh, _res, _band, cacheFile);
+}
+
+DistanceFunction_SDF::DistanceFunction_SDF(const rai::Transformation& _t, ScalarFunction f, const arr& _lo, const arr& hi, double _res) : t(_t) {
+  ScalarFunction::operator=([this](arr& g, arr& H, const arr& x)->double{ return this->f(g,H,x); });
+  bake(f, _lo, hi, _res);
+}
+
+void DistanceFunction_SDF::bake(const rai::Mesh& mesh, double _res, double _band, const char* cacheFile) {
+  CHECK(mesh.V.d0 && mesh.T.d0, "need a triangle mesh");
+  //the cache is only valid for the same mesh and parameters
+  arr key = {_res, _band, (double)mesh.V.d0, (double)mesh.T.d0, sum(mesh.V), sumOfSqr(mesh.V)};
+  if(cacheFile && rai::FileToken(cacheFile, false).exists()) {
+    arr cachedKey;
+    ifstream fil(cacheFile);
+    cachedKey.readTagged(fil, "key");
+    if(cachedKey.N==key.N && maxDiff(cachedKey, key)<1e-10) { read(fil); return; }
+  }
+  
+  res=_res;
+  band=_band;
+  lo = min(mesh.V, 0) - band;
+  arr hi = max(mesh.V, 0) + band;
+  uint n[3];
+  for(uint i=0; i<3; i++) n[i] = uint(ceil((hi(i)-lo(i))/res))+1;
+  D.resize(n[0], n[1], n[2]);
+  for(float& d:D) d=band;
+  
+  //-- unsigned distances within the band: each triangle updates the grid points within the band around its box
+  double pt[3];
+  for(uint k=0; k<mesh.T.d0; k++) {
+    const double *a=&mesh.V(mesh.T(k, 0), 0), *b=&mesh.V(mesh.T(k, 1), 0), *c=&mesh.V(mesh.T(k, 2), 0);
+    uint i0[3], i1[3];
+    for(uint i=0; i<3; i++) {
+      double tlo=rai::MIN(a[i], rai::MIN(b[i], c[i]))-band, thi=rai::MAX(a[i], rai::MAX(b[i], c[i]))+band;
+      i0[i] = uint(rai::MAX(0., ceil((tlo-lo(i))/res)));
+      i1[i] = rai::MIN(n[i]-1, uint(floor((thi-lo(i))/res)));
+    }
+    for(uint ix=i0[0]; ix<=i1[0]; ix++) for(uint iy=i0[1]; iy<=i1[1]; iy++) for(uint iz=i0[2]; iz<=i1[2]; iz++) {
+          pt[0]=lo.p[0]+ix*res; pt[1]=lo.p[1]+iy*res; pt[2]=lo.p[2]+iz*res;
+          float &d = D.p[(ix*n[1]+iy)*n[2]+iz];
+          double d2 = closestPointOnTriangle(NULL, pt, a, b, c);
+          if(d2<(double)d*d) d = sqrt(d2);
+        }
+  }
+  
+  //-- sign: parity of the triangle crossings of a ray along z through each grid column; the rays are slightly shifted, so
+  //   that they don't pass exactly through edges or vertices (of axis-aligned meshes)
+  double jitter[2] = {.0123456789*res, .0314159265*res};
+  rai::Array<arr> columns(n[0], n[1]);
+  for(uint k=0; k<mesh.T.d0; k++) {
+    const double *a=&mesh.V(mesh.T(k, 0), 0), *b=&mesh.V(mesh.T(k, 1), 0), *c=&mesh.V(mesh.T(k, 2), 0);
+    double det = (b[0]-a[0])*(c[1]-a[1]) - (c[0]-a[0])*(b[1]-a[1]);
+    if(fabs(det)<1e-20) continue; //parallel to z
+    uint i0[2], i1[2];
+    for(uint i=0; i<2; i++) {
+      i0[i] = uint(rai::MAX(0., ceil((rai::MIN(a[i], rai::MIN(b[i], c[i]))-lo(i)-jitter[i])/res)));
+      i1[i] = rai::MIN(n[i]-1, uint(floor((rai::MAX(a[i], rai::MAX(b[i], c[i]))-lo(i)-jitter[i])/res)));
+    }
+    for(uint ix=i0[0]; ix<=i1[0]; ix++) for(uint iy=i0[1]; iy<=i1[1]; iy++) {
+        //barycentric coordinates of the ray in the xy-projection of the triangle
+        double x=lo.p[0]+ix*res+jitter[0], y=lo.p[1]+iy*res+jitter[1];
+        double u = ((x-a[0])*(c[1]-a[1]) - (c[0]-a[0])*(y-a[1]))/det;
+        double v = ((b[0]-a[0])*(y-a[1]) - (x-a[0])*(b[1]-a[1]))/det;
+        if(u<0. || v<0. || u+v>1.) continue;
+        columns(ix, iy).append(a[2] + u*(b[2]-a[2]) + v*(c[2]-a[2]));
+      }
+  }
+  for(uint ix=0; ix<n[0]; ix++) for(uint iy=0; iy<n[1]; iy++) {
+      arr& z = columns(ix, iy);
+      if(!z.N) continue;
+      std::sort(z.p, z.p+z.N);
+      uint c=0;
+      for(uint iz=0; iz<n[2]; iz++) {
+        double zi=lo.p[2]+iz*res;
+        while(c<z.N && z.p[c]<zi) c++;
+        if(c&1) { float &d = D.p[(ix*n[1]+iy)*n[2]+iz]; d=-d; }
+      }
+    }
+    
+  if(cacheFile) {
+    ofstream fil(cacheFile);
+    key.writeTagged(fil, "key", true);
+    fil <<endl;
+    write(fil);
+  }
+}
+
+void DistanceFunction_SDF::bake(ScalarFunction f, const arr& _lo, const arr& hi, double _res) {
+  res=_res;
+  lo=_lo;
+  uint n[3];
+  for(uint i=0; i<3; i++) n[i] = uint(ceil((hi(i)-lo(i))/res))+1;
+  D.resize(n[0], n[1], n[2]);
+  band=0.;
+  arr x(3);
+  for(uint ix=0; ix<n[0]; ix++) for(uint iy=0; iy<n[1]; iy++) for(uint iz=0; iz<n[2]; iz++) {
+        x = {lo(0)+ix*res, lo(1)+iy*res, lo(2)+iz*res};
+        double d = f(NoArr, NoArr, x);
+        D(ix, iy, iz) = d;
+        if(fabs(d)>band) band=fabs(d);
+      }
+}
+
+double DistanceFunction_SDF::query(rai::Vector& g, const rai::Vector& x) const {
+  CHECK_EQ(D.nd, 3, "the SDF is not baked");
+  //the grid cell, clamped to the grid
+  double u[3], c[3];
+  int i[3];
+  uint n[3] = {D.d0, D.d1, D.d2};
+  double outside[3];
+  for(uint k=0; k<3; k++) {
+    double xk = (k==0?x.x:(k==1?x.y:x.z));
+    double lok = lo.p[k], hik = lok+(n[k]-1)*res;
+    outside[k] = 0.;
+    if(xk<lok) { outside[k]=xk-lok; xk=lok; }
+    if(xk>hik) { outside[k]=xk-hik; xk=hik; }
+    u[k] = (xk-lok)/res;
+    i[k] = int(u[k]);
+    if(i[k]>=int(n[k])-1) i[k]=int(n[k])-2;
+    if(i[k]<0) i[k]=0;
+    c[k] = u[k]-i[k];
+  }
+  
+  //trilinear interpolation and its gradient
+  const float *p = D.p + (i[0]*n[1]+i[1])*n[2]+i[2];
+  uint sx=n[1]*n[2], sy=n[2];
+  double d000=p[0], d001=p[1], d010=p[sy], d011=p[sy+1];
+  double d100=p[sx], d101=p[sx+1], d110=p[sx+sy], d111=p[sx+sy+1];
+  double d00 = d000+c[2]*(d001-d000), d01 = d010+c[2]*(d011-d010);
+  double d10 = d100+c[2]*(d101-d100), d11 = d110+c[2]*(d111-d110);
+  double d0 = d00+c[1]*(d01-d00), d1 = d10+c[1]*(d11-d10);
+  double d = d0+c[0]*(d1-d0);
+  g.x = (d1-d0)/res;
+  g.y = ((1.-c[0])*(d01-d00) + c[0]*(d11-d10))/res;
+  g.z = ((1.-c[0])*((1.-c[1])*(d001-d000) + c[1]*(d011-d010)) + c[0]*((1.-c[1])*(d101-d100) + c[1]*(d111-d110)))/res;
+  g.isZero=false;
+  
+  //outside of the grid: add the distance to the grid box
+  double o2 = outside[0]*outside[0]+outside[1]*outside[1]+outside[2]*outside[2];
+  if(o2>0.) {
+    double o=sqrt(o2);
+    g.set(outside[0]/o, outside[1]/o, outside[2]/o);
+    d += o;
+  }
+  return d;
+}
+
+double DistanceFunction_SDF::f(arr& g, arr& H, const arr& x) {
+  rai::Vector grad;
+  double d = query(grad, t/rai::Vector(x));
+  if(!!g) g = conv_vec2arr(t.rot*grad);
+  if(!!H) H.resize(3,3).setZero();
+  return d;
+}
+
+void DistanceFunction_SDF::write(std::ostream& os) const {
+  arr params = {res, band};
+  params.writeTagged(os, "params", true);
+  lo.writeTagged(os, "lo", true);
+  D.writeTagged(os, "D", true);
+}
+
+void DistanceFunction_SDF::read(std::istream& is) {
+  arr params;
+  params.readTagged(is, "params");
+  res=params(0);
+  band=params(1);
+  lo.readTagged(is, "lo");
+  D.readTagged(is, "D");
+}
+
+std::shared_ptr<const rai::MeshBVH> rai::Mesh::getBVH() {
+  //(GJK queries the support of the same meshes from several threads)
+  std::shared_ptr<const MeshBVH> b = std::atomic_load(&bvh);
+  if(b && b->fits(*this)) return b;
+  static Mutex bvhMutex;
+  auto lock = bvhMutex();
+  b = std::atomic_load(&bvh);
+  if(!b || !b->fits(*this)) {
+    b = std::make_shared<MeshBVH>(*this);
+    std::atomic_store(&bvh, b);
+  }
+  return b;
+}
+
+/// below, the linear scan of the vertices is about as fast as the BVH
+static const uint supportBVHMinVertices = 64;
+
 uint rai::Mesh::support(const arr &dir) {
   if(!graph.N) { //build graph
     graph.resize(V.d0);
@@ -2251,6 +2484,11 @@ uint rai::Mesh::support(const arr &dir) {
     }
   }
   
+  if(V.d0>=supportBVHMinVertices && T.d0) {
+    std::shared_ptr<const MeshBVH> b = getBVH();
+    if(b->allVertices) return b->support(Vector(dir));
+  }
+  
   arr q(V.d0);
   for(uint i=0; i<V.d0; i++) q(i) = scalarProduct(dir, V[i]);
   return argmax(q);
@@ -12,7 +12,7 @@
 #include <Core/array.h>
 #include "geo.h"
 
-namespace rai { struct Mesh; }
+namespace rai { struct Mesh; struct MeshBVH; }
 typedef rai::Array<rai::Mesh> MeshA;
 void glDrawMeshes(void*);
 
@@ -39,6 +39,7 @@ struct Mesh : GLDrawer {
   int texture=-1;       ///< GL texture name created with glBindTexture
   
   uintAA graph;         ///< for every vertex, the set of neighboring vertices
+  std::shared_ptr<const MeshBVH> bvh; ///< see getBVH()
   
   rai::Transformation glX; ///< transform (only used for drawing! Otherwise use applyOnPoints)  (optional)
   
@@ -82,7 +83,8 @@ struct Mesh : GLDrawer {
   void makeLineStrip();
   
   /// @name support function
-  uint support(const arr &dir);
+  uint support(const arr &dir); ///< the vertex furthest in direction dir -- for large meshes via the BVH
+  std::shared_ptr<const MeshBVH> getBVH(); ///< a BVH of the triangles, built on first use and rebuilt when the mesh changed (see MeshBVH::fits); thread safe
   void supportMargin(uintA& verts, const arr& dir, double margin, int initialization=-1);
   
   /// @name internal computations & cleanup
@@ -144,6 +146,7 @@ uintA getSubMeshPositions(const char* filename);
 void inertiaSphere(double *Inertia, double& mass, double density, double radius);
 void inertiaBox(double *Inertia, double& mass, double density, double dx, double dy, double dz);
 void inertiaCylinder(double *Inertia, double& mass, double density, double height, double radius);
+double closestPointOnTriangle(double *q, const double *p, const double *a, const double *b, const double *c); ///< returns the squared distance of p to triangle (a,b,c); q (optional) is the closest point
 
 /// @} end of group_geo
 
@@ -174,6 +177,29 @@ struct DistanceFunction_Cylinder:ScalarFunction {
 
 extern ScalarFunction DistanceFunction_SSBox;
 
+/// a signed distance field, baked on a regular grid in the frame t and trilinearly interpolated: distance and gradient (the
+/// surface normal) are O(1) lookups. Only grid points within the band around the surface hold exact distances, all others
+/// are clamped to +-band. Outside the grid, the distance to the grid box is added. The Hessian is zero.
+struct DistanceFunction_SDF:ScalarFunction {
+  rai::Transformation t;
+  arr lo;          ///< the lower corner of the grid (in frame t)
+  double res=.01;  ///< grid spacing
+  double band=.1;  ///< distances are exact only within this band around the surface
+  floatA D;        ///< (nx, ny, nz) signed distances at the grid points, negative inside
+
+  DistanceFunction_SDF();
+  DistanceFunction_SDF(const rai::Transformation& _t, const rai::Mesh& mesh, double _res=.01, double _band=.1, const char* cacheFile=NULL);
+  DistanceFunction_SDF(const rai::Transformation& _t, ScalarFunction f, const arr& _lo, const arr& hi, double _res=.01);
+
+  void bake(const rai::Mesh& mesh, double _res, double _band, const char* cacheFile=NULL); ///< mesh needs to be closed, as the sign is from ray parity; reads from/writes to the cache file, if given
+  void bake(ScalarFunction f, const arr& _lo, const arr& hi, double _res); ///< samples any distance function, e.g. the analytic ones above
+  double f(arr& g, arr& H, const arr& x);
+  double query(rai::Vector& g, const rai::Vector& x) const; ///< x and the gradient g in frame t
+
+  void write(std::ostream& os) const;
+  void read(std::istream& is);
+};
+
 //===========================================================================
 //
 // GJK interface
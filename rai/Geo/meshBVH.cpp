@@ -0,0 +1,259 @@
+/*  ------------------------------------------------------------------
+    Copyright (c) 2017 Marc Toussaint
+    email: marc.toussaint@informatik.uni-stuttgart.de
+
+    This code is distributed under the MIT License.
+    Please see <root-path>/LICENSE for details.
+    --------------------------------------------------------------  */
+
+#include "meshBVH.h"
+#include <algorithm>
+
+void rai::MeshBVH::build(const Mesh& _mesh, uint leafSize) {
+  CHECK(_mesh.T.d0, "the BVH is over triangles");
+  mesh = &_mesh;
+  const arr& V = mesh->V;
+  const uintA& T = mesh->T;
+
+  arr centers(T.d0, 3);
+  for(uint k=0; k<T.d0; k++) for(uint i=0; i<3; i++) {
+      centers(k, i) = (V(T(k, 0), i) + V(T(k, 1), i) + V(T(k, 2), i))/3.;
+    }
+  tris.setStraightPerm(T.d0);
+  nodes.clear();
+  buildNode(centers, 0, T.d0, leafSize);
+
+  nV = V.d0;
+  uint S = rai::MIN(8u, nV);
+  samples.resize(S, 3);
+  for(uint i=0; i<S; i++) samples[i] = V[(i*nV)/S];
+  boolA used(nV);
+  used = false;
+  for(uint v:T) used.p[v] = true;
+  allVertices = true;
+  for(bool u:used) if(!u) { allVertices=false; break; }
+}
+
+bool rai::MeshBVH::fits(const Mesh& _mesh) const {
+  if(mesh!=&_mesh || tris.N!=_mesh.T.d0 || nV!=_mesh.V.d0) return false;
+  for(uint i=0; i<samples.d0; i++) {
+    const double *v=_mesh.V.p+3*((i*nV)/samples.d0), *w=samples.p+3*i;
+    if(v[0]!=w[0] || v[1]!=w[1] || v[2]!=w[2]) return false;
+  }
+  return true;
+}
+
+uint rai::MeshBVH::buildNode(const arr& centers, uint first, uint count, uint leafSize) {
+  const arr& V = mesh->V;
+  const uintA& T = mesh->T;
+  uint n = nodes.N;
+  nodes.append(Node());
+
+  //box of all triangles, and of their centers (for the split)
+  double lo[3], hi[3], clo[3], chi[3];
+  for(uint i=0; i<3; i++) { lo[i]=clo[i]=+1e100; hi[i]=chi[i]=-1e100; }
+  for(uint k=first; k<first+count; k++) {
+    uint t=tris.p[k];
+    for(uint j=0; j<3; j++) for(uint i=0; i<3; i++) {
+        double x=V.p[3*T.p[3*t+j]+i];
+        if(x<lo[i]) lo[i]=x;
+        if(x>hi[i]) hi[i]=x;
+      }
+    for(uint i=0; i<3; i++) {
+      double c=centers.p[3*t+i];
+      if(c<clo[i]) clo[i]=c;
+      if(c>chi[i]) chi[i]=c;
+    }
+  }
+  for(uint i=0; i<3; i++) { nodes(n).lo[i]=lo[i]; nodes(n).hi[i]=hi[i]; }
+
+  uint axis=0;
+  for(uint i=1; i<3; i++) if(chi[i]-clo[i] > chi[axis]-clo[axis]) axis=i;
+  if(count<=leafSize || chi[axis]-clo[axis]<=0.) {
+    nodes(n).first=first;
+    nodes(n).count=count;
+    nodes(n).right=0;
+    return n;
+  }
+
+  //median split along the largest extent of the centers
+  uint mid = first + count/2;
+  std::nth_element(tris.p+first, tris.p+mid, tris.p+first+count, [&centers, axis](uint a, uint b) {
+    return centers.p[3*a+axis] < centers.p[3*b+axis];
+  });
+  nodes(n).first=first;
+  nodes(n).count=0;
+  buildNode(centers, first, mid-first, leafSize);
+  uint right = buildNode(centers, mid, first+count-mid, leafSize);
+  nodes(n).right = right;
+  return n;
+}
+
+/// the entry and exit parameters of the ray into the box (slab test)
+static bool rayBox(double& tin, const double *lo, const double *hi, const double *o, const double *invDir, double tmax) {
+  double t0=0., t1=tmax;
+  for(uint i=0; i<3; i++) {
+    double a = (lo[i]-o[i])*invDir[i], b = (hi[i]-o[i])*invDir[i];
+    if(a>b) std::swap(a, b);
+    if(a>t0) t0=a;
+    if(b<t1) t1=b;
+    if(t0>t1) return false;
+  }
+  tin=t0;
+  return true;
+}
+
+/// Moeller-Trumbore ray-triangle intersection
+static bool rayTriangle(double& t, const double *o, const double *d, const double *a, const double *b, const double *c) {
+  double e1[3] = {b[0]-a[0], b[1]-a[1], b[2]-a[2]};
+  double e2[3] = {c[0]-a[0], c[1]-a[1], c[2]-a[2]};
+  double p[3] = {d[1]*e2[2]-d[2]*e2[1], d[2]*e2[0]-d[0]*e2[2], d[0]*e2[1]-d[1]*e2[0]};
+  double det = e1[0]*p[0]+e1[1]*p[1]+e1[2]*p[2];
+  if(fabs(det)<1e-20) return false;
+  double inv=1./det;
+  double s[3] = {o[0]-a[0], o[1]-a[1], o[2]-a[2]};
+  double u = (s[0]*p[0]+s[1]*p[1]+s[2]*p[2])*inv;
+  if(u<0. || u>1.) return false;
+  double q[3] = {s[1]*e1[2]-s[2]*e1[1], s[2]*e1[0]-s[0]*e1[2], s[0]*e1[1]-s[1]*e1[0]};
+  double v = (d[0]*q[0]+d[1]*q[1]+d[2]*q[2])*inv;
+  if(v<0. || u+v>1.) return false;
+  t = (e2[0]*q[0]+e2[1]*q[1]+e2[2]*q[2])*inv;
+  return true;
+}
+
+bool rai::MeshBVH::rayCast(double& t, uint& tri, const Vector& origin, const Vector& dir, double tmax) const {
+  CHECK(mesh && nodes.N, "BVH is not built");
+  const double *V=mesh->V.p;
+  const uint *T=mesh->T.p;
+  double o[3] = {origin.x, origin.y, origin.z}, d[3] = {dir.x, dir.y, dir.z}, invDir[3];
+  for(uint i=0; i<3; i++) invDir[i] = 1./d[i]; //(inf for zero components is fine for the slab test)
+
+  bool hit=false;
+  double best=tmax, tin, tk;
+  uint stack[64], s=0;
+  stack[s++]=0;
+  while(s) {
+    const Node& n = nodes.p[stack[--s]];
+    if(!rayBox(tin, n.lo, n.hi, o, invDir, best)) continue;
+    if(n.count) {
+      for(uint k=n.first; k<n.first+n.count; k++) {
+        uint j=tris.p[k];
+        if(rayTriangle(tk, o, d, V+3*T[3*j], V+3*T[3*j+1], V+3*T[3*j+2]) && tk>=0. && tk<=best) {
+          best=tk;
+          tri=j;
+          hit=true;
+        }
+      }
+    } else {
+      //visit the nearer child first (pushed last)
+      uint l=&n-nodes.p+1, r=n.right;
+      double tl=0., tr=0.;
+      bool hl=rayBox(tl, nodes.p[l].lo, nodes.p[l].hi, o, invDir, best);
+      bool hr=rayBox(tr, nodes.p[r].lo, nodes.p[r].hi, o, invDir, best);
+      CHECK_LE(s+2, 64, "BVH too deep");
+      if(hl && hr) {
+        if(tl<tr) { stack[s++]=r; stack[s++]=l; } else { stack[s++]=l; stack[s++]=r; }
+      } else if(hl) stack[s++]=l;
+      else if(hr) stack[s++]=r;
+    }
+  }
+  if(hit) t=best;
+  return hit;
+}
+
+/// squared distance of x to the box
+static double sqrDistanceBox(const double *lo, const double *hi, const double *x) {
+  double d2=0.;
+  for(uint i=0; i<3; i++) {
+    if(x[i]<lo[i]) d2 += (lo[i]-x[i])*(lo[i]-x[i]);
+    else if(x[i]>hi[i]) d2 += (x[i]-hi[i])*(x[i]-hi[i]);
+  }
+  return d2;
+}
+
+double rai::MeshBVH::closestPoint(Vector& p, uint& tri, const Vector& x) const {
+  CHECK(mesh && nodes.N, "BVH is not built");
+  const double *V=mesh->V.p;
+  const uint *T=mesh->T.p;
+  double xx[3] = {x.x, x.y, x.z}, q[3];
+
+  double best=1e100;
+  uint stack[64], s=0;
+  stack[s++]=0;
+  while(s) {
+    const Node& n = nodes.p[stack[--s]];
+    if(sqrDistanceBox(n.lo, n.hi, xx)>=best) continue;
+    if(n.count) {
+      for(uint k=n.first; k<n.first+n.count; k++) {
+        uint j=tris.p[k];
+        double d2 = closestPointOnTriangle(q, xx, V+3*T[3*j], V+3*T[3*j+1], V+3*T[3*j+2]);
+        if(d2<best) { best=d2; tri=j; p.set(q); }
+      }
+    } else {
+      //visit the nearer child first
+      uint l=&n-nodes.p+1, r=n.right;
+      double dl=sqrDistanceBox(nodes.p[l].lo, nodes.p[l].hi, xx), dr=sqrDistanceBox(nodes.p[r].lo, nodes.p[r].hi, xx);
+      CHECK_LE(s+2, 64, "BVH too deep");
+      if(dl<dr) { stack[s++]=r; stack[s++]=l; } else { stack[s++]=l; stack[s++]=r; }
+    }
+  }
+  return sqrt(best);
+}
+
+uint rai::MeshBVH::support(const Vector& dir) const {
+  CHECK(mesh && nodes.N, "BVH is not built");
+  const double *V=mesh->V.p;
+  const uint *T=mesh->T.p;
+  double d[3] = {dir.x, dir.y, dir.z};
+
+  double best=-1e100;
+  uint argbest=T[0];
+  uint stack[64], s=0;
+  stack[s++]=0;
+  while(s) {
+    const Node& n = nodes.p[stack[--s]];
+    //upper bound of <dir,v> within the box
+    double bound=0.;
+    for(uint i=0; i<3; i++) bound += d[i]*(d[i]>0.?n.hi[i]:n.lo[i]);
+    if(bound<=best) continue;
+    if(n.count) {
+      for(uint k=n.first; k<n.first+n.count; k++) for(uint j=0; j<3; j++) {
+          uint v=T[3*tris.p[k]+j];
+          double x = d[0]*V[3*v]+d[1]*V[3*v+1]+d[2]*V[3*v+2];
+          if(x>best) { best=x; argbest=v; }
+        }
+    } else {
+      CHECK_LE(s+2, 64, "BVH too deep");
+      stack[s++]=n.right;
+      stack[s++]=&n-nodes.p+1;
+    }
+  }
+  return argbest;
+}
+
+void rai::MeshBVH::rayCast(arr& t, uintA& tri, const arr& origins, const arr& dirs, double tmax) const {
+  CHECK_EQ(origins.d1, 3, "");
+  CHECK_EQ(dirs.d1, 3, "");
+  CHECK_EQ(origins.d0, dirs.d0, "");
+  t.resize(origins.d0);
+  tri.resize(origins.d0);
+  Vector o, d;
+  for(uint i=0; i<origins.d0; i++) {
+    o.set(&origins(i, 0));
+    d.set(&dirs(i, 0));
+    if(!rayCast(t.p[i], tri.p[i], o, d, tmax)) { t.p[i]=-1.; tri.p[i]=0; }
+  }
+}
+
+void rai::MeshBVH::closestPoints(arr& P, arr& distances, const arr& X) const {
+  CHECK_EQ(X.d1, 3, "");
+  P.resize(X.d0, 3);
+  distances.resize(X.d0);
+  Vector x, p;
+  uint tri;
+  for(uint i=0; i<X.d0; i++) {
+    x.set(&X(i, 0));
+    distances.p[i] = closestPoint(p, tri, x);
+    P(i, 0)=p.x; P(i, 1)=p.y; P(i, 2)=p.z;
+  }
+}
@@ -0,0 +1,52 @@
+/*  ------------------------------------------------------------------
+    Copyright (c) 2017 Marc Toussaint
+    email: marc.toussaint@informatik.uni-stuttgart.de
+
+    This code is distributed under the MIT License.
+    Please see <root-path>/LICENSE for details.
+    --------------------------------------------------------------  */
+
+#pragma once
+
+#include "mesh.h"
+
+namespace rai {
+
+/// a bounding volume hierarchy (axis-aligned boxes) over the triangles of a mesh: ray casts, closest points and the support
+/// function in about logarithmic instead of linear time. It refers to the mesh (in the mesh's own frame) -- rebuild it
+/// when the mesh changes. Mesh::getBVH() builds one lazily (Mesh::support uses it for large meshes), Geom::getBVH() shares the
+/// one of the geom's mesh between all shapes of the geom
+struct MeshBVH {
+  struct Node {
+    double lo[3], hi[3];
+    uint first, count;  ///< leaf: the triangles tris[first..first+count-1]; inner node: count=0
+    uint right;         ///< inner node: the index of the right child; the left child is the next node
+  };
+
+  const Mesh *mesh=0;
+  Array<Node> nodes;
+  uintA tris;           ///< the triangle indices, sorted such that each leaf holds a contiguous range
+  uint nV=0;            ///< the mesh's number of vertices at build time
+  arr samples;          ///< a few of its vertices at build time (see fits)
+  bool allVertices=false; ///< every vertex is part of a triangle -- otherwise support() ignores some
+
+  MeshBVH() {}
+  MeshBVH(const Mesh& mesh, uint leafSize=4) { build(mesh, leafSize); }
+
+  void build(const Mesh& mesh, uint leafSize=4);
+  bool fits(const Mesh& _mesh) const; ///< a cheap check whether the mesh is still the one it was built for: same object, sizes and sampled vertices (in-place edits of single vertices go unnoticed)
+
+  /// @name queries (all in the mesh frame)
+  bool rayCast(double& t, uint& tri, const Vector& origin, const Vector& dir, double tmax=1e10) const; ///< the first hit at origin+t*dir, with t in [0, tmax]
+  double closestPoint(Vector& p, uint& tri, const Vector& x) const; ///< returns the (unsigned) distance of x to the surface, p is the closest point on it
+  uint support(const Vector& dir) const; ///< the same as Mesh::support, but only visits nodes that can contain a better vertex
+
+  /// @name batched queries: one row per query
+  void rayCast(arr& t, uintA& tri, const arr& origins, const arr& dirs, double tmax=1e10) const; ///< t=-1 for no hit
+  void closestPoints(arr& P, arr& distances, const arr& X) const;
+
+private:
+  uint buildNode(const arr& centers, uint first, uint count, uint leafSize);
+};
+
+}
@@ -19,10 +19,10 @@ extern "C" {
 #include <ccd/quat.h>
 #include <Geo/qhull.h>
 
-PairCollision::PairCollision(const rai::Mesh &_mesh1, const rai::Mesh &_mesh2, rai::Transformation &_t1, rai::Transformation &_t2, double rad1, double rad2)
+PairCollision::PairCollision(const rai::Mesh &_mesh1, const rai::Mesh &_mesh2, rai::Transformation &_t1, rai::Transformation &_t2, double rad1, double rad2, PairCollisionSeed *seed)
   : mesh1(&_mesh1), mesh2(&_mesh2), t1(&_t1), t2(&_t2), rad1(rad1), rad2(rad2) {
   
-  double d2 = GJK_sqrDistance();
+  double d2 = GJK_sqrDistance(seed);
   
   if(d2>1e-10) {
     distance = sqrt(d2);
@@ -148,7 +148,7 @@ double PairCollision::libccd_MPR(const rai::Mesh& m1,const rai::Mesh& m2) {
   return fabs(d);
 }
 
-double PairCollision::GJK_sqrDistance() {
+double PairCollision::GJK_sqrDistance(PairCollisionSeed *seed) {
   // convert meshes to 'Object_structures'
   Object_structure m1,m2;
   rai::Array<double*> Vhelp1, Vhelp2;
@@ -161,11 +161,32 @@ double PairCollision::GJK_sqrDistance() {
   if(!!t1) {  T1=t1->getAffineMatrix();  T1.getCarray(Thelp1);  }
   if(!!t2) {  T2=t2->getAffineMatrix();  T2.getCarray(Thelp2);  }
   
-  // call GJK
+  // warm start from the seed, if it fits the meshes
   simplex_point simplex;
+  int useSeed = seed && seed->npts>0 && seed->npts<=4
+                && seed->best1<m1.numpoints && seed->best2<m2.numpoints;
+  for(int i=0; useSeed && i<seed->npts; i++) {
+    if(seed->vertex1[i]<0 || seed->vertex1[i]>=m1.numpoints || seed->vertex2[i]<0 || seed->vertex2[i]>=m2.numpoints) useSeed=0;
+  }
+  if(useSeed) {
+    simplex.npts = seed->npts;
+    for(int i=0; i<seed->npts; i++) { simplex.simplex1[i]=seed->vertex1[i]; simplex.simplex2[i]=seed->vertex2[i]; }
+    simplex.last_best1 = seed->best1;
+    simplex.last_best2 = seed->best2;
+  }
+  
+  // call GJK
   p1.resize(3).setZero();
   p2.resize(3).setZero();
-  double d2 = gjk_distance(&m1, Thelp1.p, &m2, Thelp2.p, p1.p, p2.p, &simplex, 0);
+  double d2 = gjk_distance(&m1, Thelp1.p, &m2, Thelp2.p, p1.p, p2.p, &simplex, useSeed);
+  iterations = simplex.iterations;
+  
+  if(seed) {
+    seed->npts = simplex.npts;
+    for(int i=0; i<simplex.npts; i++) { seed->vertex1[i]=simplex.simplex1[i]; seed->vertex2[i]=simplex.simplex2[i]; }
+    seed->best1 = simplex.last_best1;
+    seed->best2 = simplex.last_best2;
+  }
   
   normal = p1-p2;
   normal /= length(normal);
@@ -10,6 +10,14 @@
 
 #include "mesh.h"
 
+/// the GJK state of a previous query between the same two meshes, to warm start the next query -- when the meshes move
+/// only little, GJK restarts from the previous simplex and needs fewer iterations; a seed that does not fit the meshes is ignored
+struct PairCollisionSeed {
+  int npts=0;                 ///< size of the previous simplex (0: no seed)
+  int vertex1[4], vertex2[4]; ///< mesh vertex indices of the simplex points on mesh1 and mesh2
+  int best1=0, best2=0;       ///< the last support vertices
+};
+
 struct PairCollision : GLDrawer {
   //INPUTS
   const rai::Mesh *mesh1=0;
@@ -24,6 +32,7 @@ struct PairCollision : GLDrawer {
   arr normal;      ///< normal such that "<normal, p1-p2> = distance" is guaranteed (pointing from obj2 to obj1)
   arr simplex1;    ///< simplex on obj1 defining the collision geometry
   arr simplex2;    ///< simplex on obj2 defining the collision geometry
+  uint iterations=0; ///< GJK iterations of this query
 //  arr dSimplex1, dSimplex2;
 
 //  arr m1, m2, eig1, eig2; ///< output of marginAnalysis: mean and eigenvalues of ALL point on the objs (not only simplex) that define the collision
@@ -33,7 +42,7 @@ struct PairCollision : GLDrawer {
   PairCollision(){}
   PairCollision(const rai::Mesh& mesh1, const rai::Mesh& mesh2,
                 rai::Transformation& t1, rai::Transformation& t2,
-                double rad1=0., double rad2=0.);
+                double rad1=0., double rad2=0., PairCollisionSeed *seed=NULL);
   ~PairCollision(){}
                 
   void write(std::ostream& os) const;
@@ -66,7 +75,7 @@ struct PairCollision : GLDrawer {
   
 private:
   double libccd_MPR(const rai::Mesh& m1,const rai::Mesh& m2); //calls ccdMPRPenetration of libccd
-  double GJK_sqrDistance(); //gjk_distance of libGJK
+  double GJK_sqrDistance(PairCollisionSeed *seed=NULL); //gjk_distance of libGJK, warm started from and updating the seed
   bool simplexType(uint i, uint j) { return simplex1.d0==i && simplex2.d0==j; } //helper
 };
 
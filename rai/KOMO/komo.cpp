@@ -36,6 +36,8 @@
 #include <Kin/TM_time.h>
 #include <Kin/TM_NewtonEuler.h>
 #include <Kin/TM_angVel.h>
+#include <Kin/proxy.h>
+#include <Core/thread.h>
 
 #ifdef RAI_GL
 #  include <GL/gl.h>
@@ -66,6 +68,8 @@ Shape *getShape(const KinematicWorld& K, const char* name) {
 
 KOMO::KOMO() : useSwift(true), verbose(1), komo_problem(*this), dense_problem(*this) {
   verbose = getParameter<int>("KOMO/verbose",1);
+  threads = getParameter<uint>("KOMO/threads",1);
+  useFeatureCache = getParameter<bool>("KOMO/useFeatureCache",false);
 }
 
 KOMO::KOMO(const KinematicWorld& K)
@@ -83,6 +87,8 @@ KOMO::~KOMO() {
   if(gl) delete gl;
   if(opt) delete opt;
   if(fil) delete fil;
+  listDelete(swiftCopies);
+  if(threadPool) delete threadPool;
 }
 
 void KOMO::setModel(const KinematicWorld& K,
@@ -90,6 +96,7 @@ void KOMO::setModel(const KinematicWorld& K,
                     bool optimizeTree) {
 
   if(&K!=&world) world.copy(K);
+  listDelete(swiftCopies);
 
   useSwift = _useSwift;
   
@@ -128,6 +135,7 @@ void KOMO::setTiming(double _phases, uint _stepsPerPhase, double durationPerPhas
 
 void KOMO::setPairedTimes() {
   CHECK_EQ(k_order, 1, "NIY");
+  x_applied.clear(); //all slices need an update
   for(uint s=1; s<T; s+=2) {
     configurations(s)  ->setTimes(1.98*tau); //(tau*(.98+int(s+1)-int(k_order)));
     configurations(s+1)->setTimes(0.02*tau); //(tau*(int(s)-int(k_order)));
@@ -136,6 +144,7 @@ void KOMO::setPairedTimes() {
 
 void KOMO::activateCollisions(const char* s1, const char* s2) {
   if(!useSwift) return;
+  x_applied.clear(); //the proxies of all slices need an update
   Frame *sh1 = world.getFrameByName(s1);
   Frame *sh2 = world.getFrameByName(s2);
   if(sh1 && sh2) world.swift().activate(sh1, sh2);
@@ -143,6 +152,7 @@ void KOMO::activateCollisions(const char* s1, const char* s2) {
 
 void KOMO::deactivateCollisions(const char* s1, const char* s2) {
   if(!useSwift) return;
+  x_applied.clear(); //the proxies of all slices need an update
   Frame *sh1 = world.getFrameByName(s1);
   Frame *sh2 = world.getFrameByName(s2);
   if(sh1 && sh2) world.swift().deactivate(sh1, sh2);
@@ -389,7 +399,7 @@ void KOMO::setKS_slider(double time, double endTime, bool before, const char* ob
 void KOMO::setHoming(double startTime, double endTime, double prec, const char* keyword) {
   uintA bodies;
   Joint *j;
-  for(Frame *f:world.frames) if((j=f->joint) && !j->constrainToZeroVel && j->qDim()>0 && (!keyword || f->ats[keyword])) bodies.append(f->ID);
+  for(Frame *f:world.frames) if((j=f->joint) && !j->constrainToZeroVel && j->qDim()>0 && (!keyword || f->ats()[keyword])) bodies.append(f->ID);
 //  cout <<"HOMING: "; for(uint i:bodies) cout <<' ' <<world.frames(i)->name;  cout <<endl;
   addObjective(startTime, endTime, new TM_qItself(bodies, true), OT_sos, NoArr, prec); //world.q, prec);
 }
@@ -1196,6 +1206,7 @@ void KOMO::reset(double initNoise) {
   if(!configurations.N) setupConfigurations();
   x = getPath_decisionVariable();
   dual.clear();
+  dualPenalty = 0.;
   featureValues.clear();
   featureTypes.clear();
   komo_problem.clear();
@@ -1251,6 +1262,8 @@ void KOMO::initWithWaypoints(const arrA& waypoints){
 
 void KOMO::run() {
   KinematicWorld::setJointStateCount=0;
+  uint hits0, misses0;
+  getJacobianCacheCounts(hits0, misses0);
   timerStart();
   CHECK(T,"");
   if(opt) delete opt;
@@ -1262,7 +1275,9 @@ void KOMO::run() {
     _opt.run();
   } else if(!splineB.N) {
     Convert C(komo_problem);
-    opt = new OptConstrained(x, dual, C);
+    OptOptions o = NOOPT;
+    if(dualPenalty>0. && dual.N) { o.muInit = dualPenalty;  o.aulaMuInc = 1.; }
+    opt = new OptConstrained(x, dual, C, o);
     opt->fil = fil;
     opt->run();
   } else {
@@ -1275,8 +1290,11 @@ void KOMO::run() {
   }
   runTime = timerRead();
   if(verbose>0) {
+    uint hits, misses;
+    getJacobianCacheCounts(hits, misses);
     cout <<"** optimization time=" <<runTime
-         <<" setJointStateCount=" <<KinematicWorld::setJointStateCount <<endl;
+         <<" setJointStateCount=" <<KinematicWorld::setJointStateCount
+         <<" jacobianCache hits=" <<hits-hits0 <<" misses=" <<misses-misses0 <<endl;
   }
   if(verbose>1) cout <<getReport(false) <<endl;
 }
@@ -1296,6 +1314,206 @@ void KOMO::optimize(bool initialize){
   }
 }
 
+/// forwards to a Feature that is shared between problem clones (for features without clone()): a Feature may carry
+/// internal state, so all evaluations of the shared Feature are serialized by its mutex
+struct SharedFeature : Feature {
+  Feature *map;
+  Mutex &mutex;
+  SharedFeature(Feature *map, Mutex& mutex) : map(map), mutex(mutex) {
+    order = map->order;
+    flipTargetSignOnNegScalarProduct = map->flipTargetSignOnNegScalarProduct;
+  }
+  virtual void phi(arr& y, arr& J, const rai::KinematicWorld& K) { auto lock = mutex(); map->phi(y, J, K); }
+  virtual void phi(arr& y, arr& J, const WorldL& Ktuple) { auto lock = mutex(); map->phi(y, J, Ktuple); }
+  virtual uint dim_phi(const rai::KinematicWorld& K) { auto lock = mutex(); return map->dim_phi(K); }
+  virtual uint dim_phi(const WorldL& Ktuple) { auto lock = mutex(); return map->dim_phi(Ktuple); }
+  virtual rai::String shortTag(const rai::KinematicWorld& K) { return map->shortTag(K); }
+};
+
+/* A clone has its own world, collision scene and configurations, so that it can be optimized independently. Its
+   objectives are copies with cloned features; features that can't be cloned forward to the original ones (locked by
+   featureMutexes), which serializes their evaluation across the clones. */
+static KOMO* cloneProblem(KOMO& komo, rai::Array<Mutex*>& featureMutexes) {
+  KOMO *c = new KOMO();
+  c->stepsPerPhase = komo.stepsPerPhase;
+  c->T = komo.T;
+  c->tau = komo.tau;
+  c->k_order = komo.k_order;
+  for(uint i=0; i<komo.objectives.N; i++) {
+    Objective *o = komo.objectives(i);
+    Feature *f = o->map->clone();
+    if(!f) f = new SharedFeature(o->map, *featureMutexes(i));
+    Objective *co = c->objectives.append(new Objective(f, o->type));
+    co->name = o->name;
+    co->target = o->target;
+    co->prec = o->prec;
+    co->vars = o->vars;
+  }
+  c->useSwift = komo.useSwift;
+  c->denseOptimization = komo.denseOptimization;
+  c->threads = 1;
+  c->useFeatureCache = komo.useFeatureCache;
+  c->verbose = 0;
+  c->world.copy(komo.world);
+  if(komo.useSwift) c->world.swift().syncActivations(c->world, komo.world.swift());
+  for(KinematicWorld *K:komo.configurations) c->configurations.append(new KinematicWorld())->copy(*K);
+  return c;
+}
+
+KOMO_RestartL KOMO::optimizeMultiStart(uint N, uint _threads, double initNoise, double stopCosts, double maxConstraints) {
+  CHECK(N, "");
+  CHECK(!splineB.N, "NIY");
+  if(!configurations.N) reset(0.);
+  if(!_threads) _threads = threads;
+  if(_threads>N) _threads=N;
+  timerStart();
+  
+  //-- the initializations, drawn here so that they don't depend on the thread scheduling
+  arrA x0(N);
+  for(uint i=0; i<N; i++) {
+    x0(i) = x;
+    if(i) rndGauss(x0(i), initNoise, true);
+  }
+  
+  //-- one problem clone per start, created here (the KOMO constructor reads parameters): a clone's collision state (SWIFT's
+  //closest features, the GJK seeds) carries over between queries, so starts sharing a clone would depend on the scheduling
+  rai::Array<Mutex*> featureMutexes(objectives.N);
+  for(Mutex*& m:featureMutexes) m = new Mutex;
+  rai::Array<KOMO*> clones(N);
+  for(KOMO*& c:clones) c = cloneProblem(*this, featureMutexes);
+  OptOptions opt = NOOPT;
+  opt.verbose = 0;
+  
+  KOMO_RestartL R(N);
+  std::atomic<bool> stop(false);
+  auto restart = [&](uint i, uint worker) {
+    if(stop) return;
+    KOMO& c = *clones(i);
+    KOMO_Restart& r = R[i];
+    r.start = i;
+    c.x = x0(i);
+    if(c.denseOptimization) {
+      OptConstrained o(c.x, c.dual, c.dense_problem, opt);
+      while(!o.step()) if(stop) { r.aborted=true; break; }
+      r.evals = o.newton.evals;
+    } else {
+      Convert C(c.komo_problem);
+      OptConstrained o(c.x, c.dual, C, opt);
+      while(!o.step()) if(stop) { r.aborted=true; break; }
+      r.evals = o.newton.evals;
+    }
+    r.x = c.x;
+    r.dual = c.dual;
+    r.costs = c.getCosts();
+    r.constraints = c.getConstraintViolations();
+    if(stopCosts>=0. && !r.aborted && r.constraints<=maxConstraints && r.costs<=stopCosts) stop=true;
+    delete clones(i);
+    clones(i) = NULL;
+  };
+  if(_threads>1) {
+    ThreadPool workers(_threads);
+    workers.run(N, restart);
+  } else {
+    for(uint i=0; i<N; i++) restart(i, 0);
+  }
+  
+  listDelete(clones);
+  listDelete(featureMutexes);
+  
+  //-- rank: feasible starts by costs, then the infeasible ones by constraint violations, then the aborted ones
+  KOMO_RestartL ranked;
+  for(uint i=0; i<N; i++) if(R[i].x.N) ranked.push_back(R[i]); //skipped starts remain empty
+  std::sort(ranked.begin(), ranked.end(), [maxConstraints](const KOMO_Restart& a, const KOMO_Restart& b) {
+    if(a.aborted!=b.aborted) return b.aborted;
+    bool fa = a.constraints<=maxConstraints, fb = b.constraints<=maxConstraints;
+    if(fa!=fb) return fa;
+    if(!fa && a.constraints!=b.constraints) return a.constraints<b.constraints;
+    return a.costs<b.costs;
+  });
+  
+  //-- adopt the best solution (evaluated once more, so that getReport refers to it)
+  x = ranked[0].x;
+  dual = ranked[0].dual;
+  arr phi;
+  ObjectiveTypeA tt;
+  if(denseOptimization) dense_problem.phi(phi, NoArr, NoArr, tt, x, NoArr);
+  else Conv_KOMO_ConstrainedProblem(komo_problem).phi(phi, NoArr, NoArr, tt, x, NoArr);
+  runTime = timerRead();
+  if(verbose>0) {
+    cout <<"** multi-start optimization time=" <<runTime <<" starts=" <<ranked.size() <<'/' <<N <<" threads=" <<_threads <<endl;
+    for(KOMO_Restart& r:ranked) cout <<"   start " <<r.start <<": costs=" <<r.costs <<" constraints=" <<r.constraints <<" evals=" <<r.evals <<(r.aborted?" (aborted)":"") <<endl;
+  }
+  return ranked;
+}
+
+/* The configurations are rotated rather than re-created: the first one is reused for the appended slice, all others
+   keep their state and proxies, so that the next set_x only updates the new slice. The objectives are relative to the
+   window and remain unchanged. */
+void KOMO::shiftHorizon(const arr& q_current) {
+  CHECK_EQ(configurations.N, k_order+T, "configurations are not setup yet: use komo.reset()");
+  CHECK(!switches.N && !flags.N, "NIY: switches and flags are attached to time slices");
+  CHECK(!splineB.N && !denseOptimization, "NIY");
+  
+  //-- the feature structure before the shift, to map the dual
+  uintA phiIndex0 = komo_problem.phiIndex, phiDim0 = komo_problem.phiDim;
+  uint dimPhi0 = komo_problem.dimPhi;
+  uint dim0 = dim_x(0), dimLast = dim_x(T-1);
+  
+  //-- rotate the configurations; the new last slice starts as a copy of the previous last
+  KinematicWorld *K = configurations(0);
+  configurations.remove(0);
+  KinematicWorld& last = *configurations.last();
+  CHECK_EQ(K->frames.N, last.frames.N, "");
+  K->setJointState(last.getJointState());
+  K->copyProxies(last);
+  configurations.append(K);
+  if(configurationVersions.N==k_order+T) {
+    uint v = configurationVersions(0);
+    configurationVersions.remove(0);
+    configurationVersions.append(v+1);
+  }
+  if(!!q_current) {
+    configurations(k_order-1)->setJointState(q_current);
+    configurationChanged(k_order-1);
+  }
+  
+  //-- shift x (and x_applied alike); the new last slice repeats the previous last
+  auto shift = [dim0, dimLast](arr& z) {
+    if(z.nd==2) {
+      arr tail = z[z.d0-1].copy(); //(not a reference into z, which is changed next)
+      z.delRows(0);
+      z.append(tail);
+    } else {
+      arr tail = z({z.N-dimLast, z.N-1}).copy();
+      z.remove(0, dim0);
+      z.append(tail);
+    }
+  };
+  shift(x);
+  if(x_applied.N==x.N) shift(x_applied); else x_applied.clear();
+  
+  //-- recompile the structure and carry the dual of each (slice, objective) over from the next slice
+  komo_problem.clear();
+  dense_problem.clear();
+  featureValues.clear();
+  featureTypes.clear();
+  komo_problem.getStructure(NoUintA, NoUintA, NoTermTypeA);
+  if(dual.N && dual.N==dimPhi0) {
+    if(opt) dualPenalty = opt->L.mu;
+    arr dual0 = dual;
+    dual.resize(komo_problem.dimPhi).setZero();
+    for(uint t=0; t<T; t++) for(uint i=0; i<objectives.N; i++) {
+      uint t0 = (t+1<T ? t+1 : t);
+      uint m = komo_problem.phiDim(t, i);
+      if(m && phiDim0(t0, i)==m)
+        for(uint j=0; j<m; j++) dual(komo_problem.phiIndex(t, i)+j) = dual0(phiIndex0(t0, i)+j);
+    }
+  } else {
+    dual.clear();
+    dualPenalty = 0.;
+  }
+}
+
 void KOMO_ext::getPhysicsReference(uint subSteps, int display) {
   x.resize(T, world.getJointStateDimension());
   PhysXInterface& px = world.physx();
@@ -1314,6 +1532,7 @@ void KOMO_ext::getPhysicsReference(uint subSteps, int display) {
   if(configurations.N) {
     for(uint s=0; s<k_order; s++) {
       configurations(s)->setJointState(x[0]);
+      configurationChanged(s);
     }
   }
 }
@@ -1612,27 +1831,89 @@ void KOMO::setupConfigurations() {
   }
 }
 
+void KOMO::getJacobianCacheCounts(uint& hits, uint& misses) {
+  hits=misses=0;
+  for(KinematicWorld *K:configurations) {
+    uint h, m;
+    K->getJacobianCacheCounts(h, m);
+    hits += h;
+    misses += m;
+  }
+}
+
+ThreadPool& KOMO::pool() {
+  if(!threadPool || threadPool->numThreads!=threads) {
+    if(threadPool) delete threadPool;
+    threadPool = new ThreadPool(threads);
+  }
+  return *threadPool;
+}
+
 void KOMO::set_x(const arr& x) {
   if(!configurations.N) setupConfigurations();
   CHECK_EQ(configurations.N, k_order+T, "configurations are not setup yet");
+  if(configurationVersions.N!=configurations.N) configurationVersions.resize(configurations.N).setZero();
   
-  //-- set the configurations' states
-  uint x_count=0;
+  //-- find the slices to update: x_t differs from the last applied x, or the configuration's state was changed otherwise
+  bool incremental = (x_applied.N==x.N && x_applied.nd==x.nd);
+  uint x_count=0, n=0;
+  dirtySlices.resize(T, 2);
   for(uint t=0; t<T; t++) {
-    uint s = t+k_order;
     uint x_dim = dim_x(t);
-    if(x_dim) {
-      if(x.nd==1)  configurations(s)->setJointState(x({x_count, x_count+x_dim-1}));
+    if(!x_dim) continue;
+    if(incremental) {
+      arr x_t = (x.nd==1 ? x({x_count, x_count+x_dim-1}) : x[t]);
+      arr x_prev = (x.nd==1 ? x_applied({x_count, x_count+x_dim-1}) : x_applied[t]);
+      if(x_t==x_prev && x_t==configurations(t+k_order)->q) { x_count += x_dim; continue; }
+    }
+    dirtySlices(n, 0) = t;
+    dirtySlices(n, 1) = x_count;
+    n++;
+    x_count += x_dim;
+  }
+  CHECK_EQ(x_count, x.N, "");
+  dirtySlices.resizeCopy(n, 2);
+  
+  //-- set the configurations' states
+  if(threads<=1 || n<=1) {
+    for(uint i=0; i<n; i++) {
+      uint t = dirtySlices(i, 0), x_index = dirtySlices(i, 1);
+      uint s = t+k_order;
+      if(x.nd==1)  configurations(s)->setJointState(x({x_index, x_index+dim_x(t)-1}));
       else         configurations(s)->setJointState(x[t]);
       if(useSwift) {
-        configurations(s)->stepSwift();
+        world.swift().step(*configurations(s)); //the configurations reference this scene (also when this is a problem clone)
         //configurations(s)->proxiesToContacts(1.1);
       }
-      x_count += x_dim;
+      configurationVersions(s)++;
+//      configurations(s)->checkConsistency();
     }
-//    configurations(s)->checkConsistency();
+  } else {
+    //the configurations share the world's collision scene -- it is used for the first block of slices, each further block
+    //queries its own copy; SWIFT warm starts from previous queries, so the fixed blocks keep the proxies reproducible for
+    //a given number of threads -- NOT w.r.t. the serial set_x, where one scene warm starts from the previous slice
+    ThreadPool& P = pool();
+    uint blocks = P.numThreads;
+    if(useSwift) {
+      while(swiftCopies.N+1<blocks) swiftCopies.append(new SwiftInterface(world, world.swift()));
+      for(SwiftInterface *sw:swiftCopies) sw->syncActivations(world, world.swift());
+    }
+
+    P.run(blocks, [this, &x, n, blocks](uint b, uint worker) {
+      for(uint i=(b*n)/blocks; i<((b+1)*n)/blocks; i++) {
+        uint t = dirtySlices(i, 0), x_index = dirtySlices(i, 1);
+        uint s = t+k_order;
+        if(x.nd==1)  configurations(s)->setJointState(x({x_index, x_index+dim_x(t)-1}));
+        else         configurations(s)->setJointState(x[t]);
+        if(useSwift) {
+          if(!b) world.swift().step(*configurations(s));
+          else swiftCopies(b-1)->step(*configurations(s));
+        }
+        configurationVersions(s)++;
+      }
+    });
   }
-  CHECK_EQ(x_count, x.N, "");
+  x_applied = x;
   
   if(animateOptimization>0) {
     if(animateOptimization>1){
@@ -2011,15 +2292,42 @@ void KOMO::Conv_MotionProblem_KOMO_Problem::getStructure(uintA& variableDimensio
   }
   dimPhi = M;
   CHECK_EQ(M, sum(phiDim), "");
+  
+  //-- the Ktuple of each slice and its dimensions, reused by all phi calls
+  Ktuples.resize(komo.T);
+  Ktuple_dims.resize(komo.T);
+  for(uint t=0; t<komo.T; t++) {
+    Ktuples(t) = komo.configurations({t, t+komo.k_order});
+    Ktuple_dims(t) = getKtupleDim(Ktuples(t));
+  }
+  y_raw.resize(komo.T*komo.objectives.N);
+  J_raw.resize(komo.T*komo.objectives.N);
+  rawVersion.resize(komo.T*komo.objectives.N).setZero();
 }
 
 bool WARN_FIRST_TIME=true;
 
+//copy the rows of a feature Jacobian into rows M,.. of a (preallocated) RowShifted matrix
+static void writeRowShifted(arr& J, const arr& Jy, uint M) {
+  CHECK_LE(Jy.d1, J.d1, "");
+  CHECK_LE(M+Jy.d0, J.d0, "");
+  for(uint i=0; i<Jy.d0; i++) memmove(J.p+(M+i)*J.d1, Jy.p+i*Jy.d1, Jy.d1*Jy.sizeT);
+}
+
 void KOMO::Conv_MotionProblem_KOMO_Problem::phi(arr& phi, arrA& J, arrA& H, uintA& featureTimes, ObjectiveTypeA& tt, const arr& x, arr& lambda) {
+  phi_all(phi, J, NoArr, tt, x, lambda);
+}
+
+bool KOMO::Conv_MotionProblem_KOMO_Problem::phiRowShifted(arr& phi, arr& J, arrA& H, uintA& featureTimes, ObjectiveTypeA& tt, const arr& x, arr& lambda) {
+  if(!!J) {
+    CHECK(isRowShifted(J), "J needs to be preallocated as RowShifted with one row per feature");
+    if(J.d0!=dimPhi) return false; //the structure changed since J was laid out -> the caller falls back to phi
+  }
+  return phi_all(phi, NoArrA, J, tt, x, lambda);
+}
+
+bool KOMO::Conv_MotionProblem_KOMO_Problem::phi_all(arr& phi, arrA& J, arr& J_rs, ObjectiveTypeA& tt, const arr& x, arr& lambda) {
   //==================
-  if(!!lambda) prevLambda = lambda;
-  const uintA prevPhiIndex=phiIndex, prevPhiDim=phiDim;
-  
 #if 0
   if(!!lambda && lambda.N>dimPhi) {
     //store old lambdas directly in the constraints....
@@ -2040,75 +2348,92 @@ void KOMO::Conv_MotionProblem_KOMO_Problem::phi(arr& phi, arrA& J, arrA& H, uint
   //==================
   
   //-- set the trajectory
+  uint64_t allocs = rai::globalMemoryAllocations;
   komo.set_x(x);
   
   CHECK(dimPhi,"getStructure must be called first");
-  //  getStructure(NoUintA, featureTimes, tt);
-  //  if(WARN_FIRST_TIME){ LOG(-1)<<"calling inefficient getStructure"; WARN_FIRST_TIME=false; }
-  phi.resize(dimPhi);
-  if(!!tt) tt.resize(dimPhi);
-  if(!!J) J.resize(dimPhi);
-  if(!!lambda && lambda.N) { lambda.resize(dimPhi); lambda.setZero(); }
-  
-  arr y, Jy;
-  uint M=0;
-  for(uint t=0; t<komo.T; t++) {
-    //build the Ktuple with order given by map
-    WorldL Ktuple = komo.configurations({t, t+komo.k_order});
-    uintA Ktuple_dim = getKtupleDim(Ktuple);
-    
-    for(uint i=0; i<komo.objectives.N; i++) {
-      Objective *task = komo.objectives.elem(i);
-      if(task->prec.N>t && task->prec(t)) {
-        //query the task map and check dimensionalities of returns
-        task->map->phi(y, (!!J?Jy:NoArr), Ktuple);
-        if(!!J) CHECK_EQ(y.N, Jy.d0, "");
-        if(!!J) CHECK_EQ(Jy.nd, 2, "");
-        if(!!J) CHECK_EQ(Jy.d1, Ktuple_dim.last(), "");
-        if(!y.N) continue;
-        if(absMax(y)>1e10) RAI_MSG("WARNING y=" <<y);
-        
-        //linear transform (target shift)
-        arr target;
-        if(task->target.N==1) target = consts<double>(task->target.scalar(), y.N);
-        else if(task->target.nd==1) target = task->target;
-        else if(task->target.nd==2) target = task->target[t];
-        if(target.N) {
-          if(task->map->flipTargetSignOnNegScalarProduct && scalarProduct(y, target)<-.0) target *= -1.;
-          y -= target;
+  CHECK_EQ(Ktuples.N, komo.T, "");
+  uintA dimChanged; //objectives whose features changed their dimension since getStructure
+  for(uint pass=0;; pass++) {
+    phi.resize(dimPhi);
+    if(!!tt) tt.resize(dimPhi);
+    if(!!J) J.resize(dimPhi);
+    //the multipliers keep their indices as long as the structure is unchanged
+    if(!!lambda && lambda.N && lambda.N!=dimPhi) lambda.resizeCopy(dimPhi);
+    dimChanged.resize(komo.objectives.N).setZero();
+
+    if(komo.threads<=1) {
+      if(!y_buf.N) { y_buf.resize(1); Jy_buf.resize(1); }
+      arr& y = y_buf(0);
+      arr& Jy = Jy_buf(0);
+      for(uint t=0; t<komo.T; t++) {
+        for(uint i=0; i<komo.objectives.N; i++) {
+          Objective *task = komo.objectives.elem(i);
+          if(!(task->prec.N>t && task->prec(t))) continue;
+          rai::ArrayArena arena; //the temporaries of the feature evaluation
+          phi_t(y, (!!J || !!J_rs?Jy:NoArr), t, i);
+          if(y.N!=phiDim(t,i)) { dimChanged(i)=1; continue; }
+
+          //write into phi and J
+          uint M = phiIndex(t,i);
+          phi.setVectorBlock(y, M);
+          if(!!J) for(uint i=0; i<y.N; i++) J(M+i) = Jy[i]; //copy it to J(M+i); which is the Jacobian of the M+i'th feature w.r.t. its variables
+          if(!!J_rs) writeRowShifted(J_rs, Jy, M);
+          if(!!tt) for(uint i=0; i<y.N; i++) tt(M+i) = task->type;
         }
-        y *= task->prec(t);
-        
-        //write into phi and J
-        phi.setVectorBlock(y, M);
-        if(!!J) {
-          Jy *= task->prec(t);
-          if(t<komo.k_order) Jy.delColumns(0, Ktuple_dim(komo.k_order-t-1)); //delete the columns that correspond to the prefix!!
-//          if(t<komo.k_order) Jy.delColumns(0,(komo.k_order-t)*komo.configurations(0)->q.N); //delete the columns that correspond to the prefix!!
-          for(uint i=0; i<y.N; i++) J(M+i) = Jy[i]; //copy it to J(M+i); which is the Jacobian of the M+i'th feature w.r.t. its variables
-        }
-        if(!!tt) for(uint i=0; i<y.N; i++) tt(M+i) = task->type;
-        
-        //transfer Lambda values
-        if(!!lambda && lambda.N && y.N==prevPhiDim(t,i)) {
-          lambda.setVectorBlock(prevLambda({prevPhiIndex(t,i), prevPhiIndex(t,i)+y.N-1}), M);
+      }
+    } else {
+      ThreadPool& pool = komo.pool();
+      if(y_buf.N!=pool.numThreads) { y_buf.resize(pool.numThreads); Jy_buf.resize(pool.numThreads); }
+
+      //the proxies' collision details are computed lazily by the features -- do this beforehand, per slice
+      if(komo.useSwift) pool.run(komo.configurations.N, [this](uint s, uint worker) {
+        KinematicWorld& K = *komo.configurations(s);
+        for(Proxy& p:K.proxies) if(!p.coll) p.calc_coll(K);
+      });
+
+      //one job per objective: a Feature object may carry internal state and is never evaluated concurrently;
+      //all slices write into the offsets phiIndex/phiDim computed by getStructure
+      pool.run(komo.objectives.N, [&](uint i, uint worker) {
+        Objective *task = komo.objectives.elem(i);
+        arr& y = y_buf(worker);
+        arr& Jy = Jy_buf(worker);
+        for(uint t=0; t<komo.T; t++) {
+          if(!(task->prec.N>t && task->prec(t))) continue;
+          rai::ArrayArena arena;
+          phi_t(y, (!!J || !!J_rs?Jy:NoArr), t, i);
+          if(y.N!=phiDim(t,i)) { dimChanged(i)=1; continue; }
+
+          uint M = phiIndex(t,i);
+          phi.setVectorBlock(y, M);
+          if(!!J) for(uint j=0; j<y.N; j++) J(M+j) = Jy[j];
+          if(!!J_rs) writeRowShifted(J_rs, Jy, M);
+          if(!!tt) for(uint j=0; j<y.N; j++) tt(M+j) = task->type;
         }
-        
-//        //store indexing phi <-> tasks
-//        phiIndex(t, i) = M;
-//        phiDim(t, i) = y.N;
-
-        //counter for features phi
-        M += y.N;
+      });
+    }
+    if(!sum(dimChanged)) break;
+
+    //-- features of variable dimension: query the structure again; the multipliers of features with unchanged
+    //   dimension are transferred to their new indices, the others are zero
+    CHECK(!pass, "the feature dimensions changed again right after getStructure");
+    uintA prevPhiIndex=phiIndex, prevPhiDim=phiDim;
+    getStructure(NoUintA, NoUintA, NoTermTypeA);
+    if(!!lambda && lambda.N) {
+      arr prevLambda = lambda;
+      lambda.resize(dimPhi).setZero();
+      for(uint t=0; t<komo.T; t++) for(uint i=0; i<komo.objectives.N; i++) {
+        uint m = phiDim(t,i);
+        if(m && m==prevPhiDim(t,i)) lambda.setVectorBlock(prevLambda({prevPhiIndex(t,i), prevPhiIndex(t,i)+m-1}), phiIndex(t,i));
       }
     }
+    if(!!J_rs) return false; //J_rs was laid out for the previous structure
   }
   
-  CHECK_EQ(M, dimPhi, "");
-//  if(!!lambda) CHECK_EQ(prevLambda, lambda, ""); //this ASSERT only holds is none of the tasks is variable dim!
   komo.featureValues = phi;
   if(!!tt) komo.featureTypes = tt;
   komo.featureDense=false;
+  phiAllocations = rai::globalMemoryAllocations - allocs;
 
   //==================
 #if 0
@@ -2142,6 +2467,59 @@ void KOMO::Conv_MotionProblem_KOMO_Problem::phi(arr& phi, arrA& J, arrA& H, uint
 #endif
   //==================
   
+  return true;
+}
+
+static void subtractTarget(arr& y, const arr& target, bool flipSignOnNegScalarProduct) {
+  if(flipSignOnNegScalarProduct && scalarProduct(y, target)<-.0) y += target;
+  else y -= target;
+}
+
+void KOMO::Conv_MotionProblem_KOMO_Problem::phi_t(arr& y, arr& Jy, uint t, uint i) {
+  Objective *task = komo.objectives.elem(i);
+  const WorldL& Ktuple = Ktuples(t);
+  const uintA& Ktuple_dim = Ktuple_dims(t);
+  
+  if(komo.useFeatureCache) {
+    //query the task map only if the Ktuple changed (or the Jacobian is missing)
+    uint c = t*komo.objectives.N + i;
+    uint version = 1;
+    for(uint s=t; s<=t+komo.k_order; s++) version += komo.configurationVersions(s);
+    if(rawVersion(c)!=version || (!!Jy && !J_raw(c).N)) {
+      task->map->phi(y_raw(c), (!!Jy?J_raw(c):NoArr), Ktuple);
+      if(!Jy) J_raw(c).resize(0);
+      rawVersion(c) = version;
+    }
+    y = y_raw(c);
+    if(!!Jy) Jy = J_raw(c);
+  } else {
+    task->map->phi(y, Jy, Ktuple);
+  }
+  
+  //check dimensionalities of returns
+  if(!!Jy) CHECK_EQ(y.N, Jy.d0, "");
+  if(!!Jy) CHECK_EQ(Jy.nd, 2, "");
+  if(!!Jy) CHECK_EQ(Jy.d1, Ktuple_dim.last(), "");
+  if(!y.N) return;
+  if(absMax(y)>1e10) RAI_MSG("WARNING y=" <<y);
+
+  //linear transform (target shift) -- without copying the target
+  if(task->target.N==1) {
+    double target = task->target.scalar();
+    if(task->map->flipTargetSignOnNegScalarProduct && sum(y)*target<-.0) target *= -1.;
+    y -= target;
+  } else if(task->target.nd==1) {
+    subtractTarget(y, task->target, task->map->flipTargetSignOnNegScalarProduct);
+  } else if(task->target.nd==2) {
+    subtractTarget(y, task->target[t], task->map->flipTargetSignOnNegScalarProduct);
+  }
+  y *= task->prec(t);
+
+  if(!!Jy) {
+    Jy *= task->prec(t);
+    if(t<komo.k_order) Jy.delColumns(0, Ktuple_dim(komo.k_order-t-1)); //delete the columns that correspond to the prefix!!
+//    if(t<komo.k_order) Jy.delColumns(0,(komo.k_order-t)*komo.configurations(0)->q.N); //delete the columns that correspond to the prefix!!
+  }
 }
 
 void KOMO::Conv_MotionProblem_DenseProblem::phi(arr& phi, arr& J, arr& H, ObjectiveTypeA& tt, const arr& x, arr& lambda) {
@@ -30,6 +30,19 @@ typedef rai::Array<SkeletonEntry> Skeleton;
 
 //===========================================================================
 
+/// the outcome of one start of KOMO::optimizeMultiStart
+struct KOMO_Restart {
+  uint start=0;          ///< 0: started from the current x; otherwise from x plus noise
+  arr x, dual;           ///< the primal and dual solution
+  double costs=0.;       ///< getCosts() at the solution
+  double constraints=0.; ///< getConstraintViolations() at the solution
+  uint evals=0;          ///< number of problem evaluations
+  bool aborted=false;    ///< stopped early because another start met the cost threshold
+};
+typedef std::vector<KOMO_Restart> KOMO_RestartL; //(not a rai::Array: the elements hold arrs and must not be memmoved)
+
+//===========================================================================
+
 struct KOMO : NonCopyable {
 
   //-- the problem definition
@@ -50,7 +63,19 @@ struct KOMO : NonCopyable {
   bool denseOptimization=false;///< calls optimization with a dense (instead of banded) representation
   OptConstrained *opt=0;       ///< optimizer; created in run()
   arr x, dual;                 ///< the primal and dual solution
+  double dualPenalty=0.;       ///< (set by shiftHorizon) the penalty of the solve that computed dual: run() continues from the warm
+                               ///< dual with this penalty, held fixed -- the dual alone is no valid warm start for a fresh penalty
   arr z, splineB;              ///< when a spline representation is used: z are the nodes; splineB the B-spline matrix; x = splineB * z
+  uint threads=1;              ///< number of threads to evaluate the features (1=serial); set by KOMO/threads
+                               ///< (with useSwift, set_x queries the collisions of each block of slices with its own SWIFT copy: the proxies,
+                               ///<  and so the solutions, are reproducible for a fixed number of threads, but may differ from the serial ones)
+  struct ThreadPool *threadPool=0; ///< internal only: created by pool() if threads>1
+  rai::Array<SwiftInterface*> swiftCopies; ///< internal only: collision scenes of the workers>0 for a parallel set_x
+  arr x_applied;               ///< internal only: the x last applied by set_x -- only slices whose x_t changed are updated
+  uintA dirtySlices;           ///< (t, x_index) of the slices that the last set_x updated
+  uintA configurationVersions; ///< incremented for each configuration whenever set_x changes its state (see configurationChanged)
+  bool useFeatureCache=false;  ///< reuse the features of slices whose configurations' versions are unchanged; only valid if the features
+                               ///< depend on nothing but these configurations, and direct writes to them call configurationChanged
   
   //-- verbosity only: buffers of all feature values computed on last set_x
   arr featureValues;           ///< storage of all features in all time slices
@@ -165,6 +190,8 @@ struct KOMO : NonCopyable {
   void initWithWaypoints(const arrA& waypoints);
   void run();                        ///< run the optimization (using OptConstrained -- its parameters are read from the cfg file)
   void optimize(bool initialize=true);
+  KOMO_RestartL optimizeMultiStart(uint N, uint threads=0, double initNoise=.1, double stopCosts=-1., double maxConstraints=1e-2); ///< optimize from N initializations concurrently; sets x,dual to the best and returns all starts, best first
+  void shiftHorizon(const arr& q_current=NoArr); ///< receding horizon: drop the first slice, append a copy of the last; x, dual are shifted as warm start; q_current overwrites the state of the last prefix slice
 
   rai::KinematicWorld& getConfiguration(double phase);
   arr getJointState(double phase);
@@ -206,21 +233,38 @@ struct KOMO : NonCopyable {
   void setupConfigurations();   ///< this creates the @configurations@, that is, copies the original world T times (after setTiming!) perhaps modified by KINEMATIC SWITCHES and FLAGS
 //  arr getInitialization();      ///< this reads out the initial state trajectory after 'setupConfigurations'
   void set_x(const arr& x);            ///< set the state trajectory of all configurations
+  void configurationChanged(uint s) { if(s<configurationVersions.N) configurationVersions(s)++; } ///< call after writing configurations(s) other than by set_x (e.g. the prefix)
   uint dim_x(uint t) { return configurations(t+k_order)->getJointStateDimension(); }
+  ThreadPool& pool();                  ///< the thread pool for parallel evaluation, created on demand with @threads@ threads
+  void getJacobianCacheCounts(uint& hits, uint& misses); ///< summed over all configurations (see KinematicWorld::useJacobianCache)
 
   struct Conv_MotionProblem_KOMO_Problem : KOMO_Problem {
     KOMO& komo;
     uint dimPhi;
-    arr prevLambda;
     uintA phiIndex, phiDim;
     StringA featureNames;
+    rai::Array<WorldL> Ktuples; ///< compiled by getStructure: the configurations each slice's features depend on..
+    uintAA Ktuple_dims;         ///< ..and their dimensions
+    arrA y_buf, Jy_buf;         ///< per worker buffers for single feature evaluations, reused across phi calls
+    arrA y_raw, J_raw;          ///< (useFeatureCache) raw feature values of each (slice, objective), reused while the Ktuple's configurations are unchanged
+    uintA rawVersion;           ///< 1+sum of the Ktuple's configurationVersions when y_raw, J_raw were computed (0: invalid)
+    uint64_t phiAllocations=0;  ///< number of Array heap allocations during the last phi call (incl. set_x and the features)
     
     Conv_MotionProblem_KOMO_Problem(KOMO& _komo) : komo(_komo) {}
-    void clear(){ dimPhi=0; prevLambda.clear(); phiIndex.clear(); phiDim.clear(); featureNames.clear(); }
+    void clear(){ dimPhi=0; phiIndex.clear(); phiDim.clear(); featureNames.clear(); Ktuples.clear(); Ktuple_dims.clear(); rawVersion.clear(); }
 
     virtual uint get_k() { return komo.k_order; }
     virtual void getStructure(uintA& variableDimensions, uintA& featureTimes, ObjectiveTypeA& featureTypes);
     virtual void phi(arr& phi, arrA& J, arrA& H, uintA& featureTimes, ObjectiveTypeA& tt, const arr& x, arr& lambda);
+    virtual bool phiRowShifted(arr& phi, arr& J, arrA& H, uintA& featureTimes, ObjectiveTypeA& tt, const arr& x, arr& lambda);
+    
+    //computes phi and writes the features' Jacobians either into the array J or into the rows of the RowShifted J_rs;
+    //if features changed their dimension, the structure is recomputed (and false returned if J_rs doesn't fit anymore)
+    bool phi_all(arr& phi, arrA& J, arr& J_rs, ObjectiveTypeA& tt, const arr& x, arr& lambda);
+
+    //evaluates objective i at slice t: target shifted, scaled, and Jacobian w.r.t. the slice's (non-prefix) variables;
+    //with useFeatureCache, the feature itself is only queried if one of the slice's configurations changed since the last evaluation
+    void phi_t(arr& y, arr& Jy, uint t, uint i);
   } komo_problem;
 
   struct Conv_MotionProblem_DenseProblem : ConstrainedProblem {
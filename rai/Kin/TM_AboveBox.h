@@ -22,4 +22,5 @@ struct TM_AboveBox : Feature {
   virtual uint dim_phi(const rai::KinematicWorld& G) { return 4; }
   virtual rai::String shortTag(const rai::KinematicWorld& G);
   virtual Graph getSpec(const rai::KinematicWorld& K);
+  virtual Feature* clone() const { return new TM_AboveBox(*this); }
 };
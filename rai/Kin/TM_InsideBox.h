@@ -22,4 +22,5 @@ struct TM_InsideBox : Feature {
   virtual void phi(arr& y, arr& J, const rai::KinematicWorld& G);
   virtual uint dim_phi(const rai::KinematicWorld& G);
   virtual rai::String shortTag(const rai::KinematicWorld& G);
+  virtual Feature* clone() const { return new TM_InsideBox(*this); }
 };
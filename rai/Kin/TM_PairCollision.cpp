@@ -10,6 +10,13 @@
 #include "frame.h"
 #include <Geo/pairCollision.h>
 
+/// J(0, cols(c)) += sign * normal^T Jp(:,c) -- scatters a compact jacobianPos block projected onto the normal
+static void addNormalColumns(arr& J, const arr& normal, const arr& Jp, const uintA& cols, double sign) {
+  for(uint c=0; c<cols.N; c++) {
+    J.p[cols.p[c]] += sign*(normal.p[0]*Jp.p[c] + normal.p[1]*Jp.p[cols.N+c] + normal.p[2]*Jp.p[2*cols.N+c]);
+  }
+}
+
 TM_PairCollision::TM_PairCollision(int _i, int _j, Type _type, bool _neglectRadii)
   : i(_i), j(_j), type(_type), neglectRadii(_neglectRadii) {
 }
@@ -34,12 +41,25 @@ void TM_PairCollision::phi(arr& y, arr& J, const rai::KinematicWorld& K) {
   rai::Mesh *m1 = &s1->sscCore();  if(!m1->V.N) { m1 = &s1->mesh(); r1=0.; }
   rai::Mesh *m2 = &s2->sscCore();  if(!m2->V.N) { m2 = &s2->mesh(); r2=0.; }
   
+  PairCollisionSeed seed;
+  if(K.useCollisionSeeds) K.getCollisionSeed(seed, i, j);
   if(coll) delete coll;
-  coll = new PairCollision(*m1, *m2, s1->frame.X, s2->frame.X, r1, r2);
+  coll = new PairCollision(*m1, *m2, s1->frame.X, s2->frame.X, r1, r2, &seed);
+  K.putCollisionSeed(seed, i, j, coll->iterations);
   
   if(neglectRadii) coll->rad1=coll->rad2=0.;
   
-  if(type==_negScalar) {
+  if(type==_negScalar && !!J && !K.useJacobianCache) { //compact Jacobians: only the ancestor columns, no 3xN intermediates
+    arr Jp1, Jp2;
+    uintA cols1, cols2;
+    K.jacobianPos(Jp1, cols1, &s1->frame, coll->p1);
+    K.jacobianPos(Jp2, cols2, &s2->frame, coll->p2);
+    y = ARR(coll->rad1+coll->rad2-coll->distance);
+    J.resize(1, K.getJointStateDimension()).setZero();
+    addNormalColumns(J, coll->normal, Jp1, cols1, -1.);
+    addNormalColumns(J, coll->normal, Jp2, cols2, +1.);
+    checkNan(J);
+  }else if(type==_negScalar) {
     arr Jp1, Jp2;
     K.jacobianPos(Jp1, &s1->frame, coll->p1);
     K.jacobianPos(Jp2, &s2->frame, coll->p2);
@@ -25,4 +25,5 @@ struct TM_PairCollision : Feature {
   virtual uint dim_phi(const rai::KinematicWorld& G) { if(type==_negScalar) return 1;  return 3; }
   virtual rai::String shortTag(const rai::KinematicWorld& G);
   virtual Graph getSpec(const rai::KinematicWorld& K);
+  virtual Feature* clone() const { TM_PairCollision *f = new TM_PairCollision(*this); f->coll=0; return f; } ///< (coll is the result of the last evaluation)
 };
@@ -0,0 +1,50 @@
+/*  ------------------------------------------------------------------
+    Copyright (c) 2017 Marc Toussaint
+    email: marc.toussaint@informatik.uni-stuttgart.de
+
+    This code is distributed under the MIT License.
+    Please see <root-path>/LICENSE for details.
+    --------------------------------------------------------------  */
+
+#include "TM_SDFDistance.h"
+#include "frame.h"
+#include <Geo/geoms.h>
+
+TM_SDFDistance::TM_SDFDistance(const rai::KinematicWorld& K, const char* s1, const char* s2)
+  : i(initIdArg(K, s1)), j(initIdArg(K, s2)) {
+  CHECK_GE(i, 0,"shape name '" <<s1 <<"' does not exist");
+  CHECK_GE(j, 0,"shape name '" <<s2 <<"' does not exist");
+}
+
+void TM_SDFDistance::phi(arr& y, arr& J, const rai::KinematicWorld& K) {
+  rai::Frame *f1 = K.frames(i), *f2 = K.frames(j);
+  CHECK(f1->shape && f1->shape->geom && f1->shape->geom->sdf, "frame '" <<f1->name <<"' has no baked SDF (shape attribute sdf=<resolution>)");
+  CHECK(f2->shape, "");
+  const DistanceFunction_SDF& sdf = *f1->shape->geom->sdf;
+  double r = f2->shape->radius();
+  rai::Mesh *m = &f2->shape->sscCore();  if(!m->V.N) { m = &f2->shape->mesh(); r=0.; }
+  CHECK(m->V.d0, "");
+  
+  //the closest vertex of shape j
+  double d=0.;
+  rai::Vector v, p, g, pmin, gmin;
+  for(uint k=0; k<m->V.d0; k++) {
+    v.set(&m->V(k, 0));
+    p = f2->X * v;
+    double dk = sdf.query(g, f1->X / p);
+    if(!k || dk<d) { d=dk; pmin=p; gmin=g; }
+  }
+  
+  y = ARR(-(d-r));
+  if(!!J) {
+    arr Jp1, Jp2;
+    K.jacobianPos(Jp1, f1, pmin);
+    K.jacobianPos(Jp2, f2, pmin);
+    arr n = conv_vec2arr(f1->X.rot * gmin);
+    J = -(~n * (Jp2-Jp1));
+  }
+}
+
+rai::String TM_SDFDistance::shortTag(const rai::KinematicWorld& K) {
+  return STRING("SDFDistance-" <<K.frames(i)->name <<'-' <<K.frames(j)->name);
+}
@@ -0,0 +1,24 @@
+/*  ------------------------------------------------------------------
+    Copyright (c) 2017 Marc Toussaint
+    email: marc.toussaint@informatik.uni-stuttgart.de
+
+    This code is distributed under the MIT License.
+    Please see <root-path>/LICENSE for details.
+    --------------------------------------------------------------  */
+
+#pragma once
+
+#include "feature.h"
+
+/// the distance of shape j to shape i, looked up in the baked signed distance field of shape i (see Geom::sdf), e.g. a large
+/// static environment mesh: the minimum over the vertices of j's core (or mesh), minus j's radius. This is exact for spheres and
+/// otherwise only considers the vertices; but each vertex is an O(1) lookup instead of GJK. As FS_distance, y is the NEGATIVE distance
+struct TM_SDFDistance : Feature {
+  int i, j;               ///< the shape with the SDF, and the querying shape
+  
+  TM_SDFDistance(int _i, int _j) : i(_i), j(_j) {}
+  TM_SDFDistance(const rai::KinematicWorld& K, const char* s1, const char* s2);
+  virtual void phi(arr& y, arr& J, const rai::KinematicWorld& K);
+  virtual uint dim_phi(const rai::KinematicWorld& K) { return 1; }
+  virtual rai::String shortTag(const rai::KinematicWorld& K);
+};
@@ -20,6 +20,7 @@ struct TM_LinVel : Feature {
   virtual void phi(arr& y, arr& J, const WorldL& Ktuple);
   virtual uint dim_phi(const rai::KinematicWorld& G){ return 3; }
   virtual rai::String shortTag(const rai::KinematicWorld& G){ return STRING("TM_LinVel-" <<order <<'-' <<G.frames(i)->name); }
+  virtual Feature* clone() const { return new TM_LinVel(*this); }
 };
 
 
@@ -35,6 +36,7 @@ struct TM_AngVel : Feature {
   virtual void phi(arr& y, arr& J, const WorldL& Ktuple);
   virtual uint dim_phi(const rai::KinematicWorld& G);
   virtual rai::String shortTag(const rai::KinematicWorld& G){ return STRING("AngVel-" <<order <<'-' <<G.frames(i)->name); }
+  virtual Feature* clone() const { return new TM_AngVel(*this); }
 };
 
 //===========================================================================
@@ -50,4 +52,5 @@ struct TM_LinAngVel : Feature {
   virtual void phi(arr& y, arr& J, const WorldL& Ktuple);
   virtual uint dim_phi(const rai::KinematicWorld& G);
   virtual rai::String shortTag(const rai::KinematicWorld& G){ return STRING("LinAngVel-" <<order <<'-' <<G.frames(i)->name); }
+  virtual Feature* clone() const { return new TM_LinAngVel(*this); }
 };
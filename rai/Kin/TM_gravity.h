@@ -45,6 +45,7 @@ struct TM_ZeroAcc : Feature {
   virtual void phi(arr& y, arr& J, const WorldL& Ktuple);
   virtual uint dim_phi(const rai::KinematicWorld& G){ return 3; }
   virtual rai::String shortTag(const rai::KinematicWorld& G){ return STRING("ZeroAcc-" <<G.frames(i)->name); }
+  virtual Feature* clone() const { return new TM_ZeroAcc(*this); }
 };
 
 struct TM_ZeroQVel : Feature {
@@ -57,4 +58,5 @@ struct TM_ZeroQVel : Feature {
   virtual void phi(arr& y, arr& J, const WorldL& Ktuple);
   virtual uint dim_phi(const rai::KinematicWorld& G);
   virtual rai::String shortTag(const rai::KinematicWorld& G){ return STRING("ZeroQVel-" <<G.frames(i)->name); }
+  virtual Feature* clone() const { return new TM_ZeroQVel(*this); }
 };
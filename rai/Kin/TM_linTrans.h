@@ -21,4 +21,5 @@ struct TM_LinTrans : Feature {
   virtual void phi(arr& y, arr& J, const rai::KinematicWorld& G);
   virtual uint dim_phi(const rai::KinematicWorld& G);
   virtual rai::String shortTag(const rai::KinematicWorld& G) { return STRING("LinTrans:"<<map->shortTag((G))); }
+  virtual Feature* clone() const { Feature *m = map->clone(); if(!m) return NULL; TM_LinTrans *f = new TM_LinTrans(*this); f->map=m; return f; }
 };
@@ -42,6 +42,7 @@ struct TM_Proxy : Feature {
   virtual uint dim_phi(const rai::KinematicWorld& G);
   virtual rai::String shortTag(const rai::KinematicWorld& G) { return STRING("ProxyCost"); }
   virtual Graph getSpec(const rai::KinematicWorld& K){ return Graph({{"feature", "ProxyCost"}}); }
+  virtual Feature* clone() const { return new TM_Proxy(*this); }
 };
 
 //===========================================================================
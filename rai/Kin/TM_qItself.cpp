@@ -17,7 +17,7 @@ TM_qItself::TM_qItself(TM_qItself_PickMode pickMode, const StringA& picks, const
   if(pickMode==QIP_byJointGroups) {
     for(rai::Frame *f: K.frames) {
       bool pick=false;
-      for(const rai::String& s:picks) if(f->ats.getNode(s)) { pick=true; break; }
+      for(const rai::String& s:picks) if(f->ats().getNode(s)) { pick=true; break; }
       if(pick) selectedBodies.setAppend(f->ID);
     }
     return;
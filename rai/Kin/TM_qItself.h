@@ -28,6 +28,7 @@ struct TM_qItself:Feature {
   virtual uint dim_phi(const rai::KinematicWorld& G);
   virtual uint dim_phi(const WorldL& Ktuple);
   virtual rai::String shortTag(const rai::KinematicWorld& G);
+  virtual Feature* clone() const { TM_qItself *f = new TM_qItself(*this); f->dimPhi.clear(); return f; }
 private:
   std::map<rai::KinematicWorld*, uint> dimPhi;
 };
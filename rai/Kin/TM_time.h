@@ -18,4 +18,5 @@ struct TM_Time : Feature {
   virtual uint dim_phi(const WorldL& Ktuple) { return 1; }
   
   virtual rai::String shortTag(const rai::KinematicWorld& G) { return STRING("Time"); }
+  virtual Feature* clone() const { return new TM_Time(*this); }
 };
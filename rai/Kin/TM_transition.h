@@ -27,4 +27,5 @@ struct TM_Transition:Feature {
   virtual uint dim_phi(const WorldL& G);
   virtual rai::String shortTag(const rai::KinematicWorld& G) { return STRING("Transition:"<<(effectiveJointsOnly?"eDOF":"") <<":pos" <<posCoeff <<":vel" <<velCoeff<<":acc"<<accCoeff); }
   virtual Graph getSpec(const rai::KinematicWorld& K){ return Graph({{"feature", "Transition"}}); }
+  virtual Feature* clone() const { return new TM_Transition(*this); }
 };
@@ -115,6 +115,55 @@ void rai::CameraView::watch_PCL(const arr& pts, const byteA& rgb){
 
 }
 
+void rai::CameraView::computeDepthByRayCasting(arr& depth){
+  updateCamera();
+  uint H=gl.height, W=gl.width;
+  if(currentSensor){ H=currentSensor->height; W=currentSensor->width; }
+  rai::Camera& cam = gl.camera;
+  CHECK(cam.focalLength>0, "need a focal length greater zero!(not implemented for ortho yet)");
+  int centerX = (W >> 1);
+  int centerY = (H >> 1);
+  double focal_x = 1./(cam.focalLength*H);
+  double focal_y = 1./(cam.focalLength*H);
+
+  //the shapes to cast against, and their bounding spheres
+  rai::Array<rai::Frame*> F;
+  std::vector<std::shared_ptr<const rai::MeshBVH>> bvhs;
+  arr radius;
+  for(rai::Frame *f:K.frames) if(f->shape){
+    rai::Shape *s=f->shape;
+    if(s->type()==rai::ST_marker || s->type()==rai::ST_pointCloud) continue;
+    rai::Geom& g = s->getGeom();
+    if(!g.mesh.T.N) g.createMeshes();
+    if(!g.mesh.T.N) continue;
+    bvhs.push_back(g.getBVH());
+    F.append(f);
+    radius.append(g.mesh.getRadius());
+  }
+
+  depth.resize(H, W);
+  rai::Vector o, d, oo, dd;
+  double t;
+  uint tri, i=0;
+  for(int y=-centerY+1; y<=centerY; y++) for(int x=-centerX+1; x<=centerX; x++, i++) {
+    //the ray in world coordinates; t along d is the depth, as d has unit z in the camera frame
+    o = cam.X.pos;
+    d = cam.X.rot * rai::Vector(focal_x*x, -focal_y*y, -1.);
+    double best=-1.;
+    for(uint k=0; k<F.N; k++){
+      const rai::Transformation& X = F.p[k]->X;
+      oo = X.rot / (o - X.pos);
+      dd = X.rot / d;
+      //skip shapes whose bounding sphere the ray misses
+      double tc = (-oo*dd)/dd.lengthSqr();
+      if((oo + tc*dd).lengthSqr() > radius.p[k]*radius.p[k]) continue;
+      if(bvhs[k]->rayCast(t, tri, oo, dd, best<0.?1e10:best)) best=t;
+    }
+    depth.elem(i) = best;
+  }
+  done(__func__);
+}
+
 void rai::CameraView::updateCamera(){
   for(Sensor& sen:sensors){
     if(sen.frame) sen.cam.X = sen.frame->X;
@@ -45,6 +45,7 @@ struct CameraView : GLDrawer {
   void computeKinectDepth(uint16A& kinect_depth, const arr& depth);
   void computePointCloud(arr& pts, const arr& depth, bool globalCoordinates=true); // point cloud (rgb of every point is given in image)
   void computeSegmentation(byteA& segmentation);     // -> segmentation
+  void computeDepthByRayCasting(arr& depth);         // the same depth as computeImageAndDepth, but by ray casting the meshes (no OpenGL needed)
 
   //-- displays
   void watch_PCL(const arr& pts, const byteA& rgb);
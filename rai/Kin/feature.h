@@ -22,6 +22,7 @@ struct Feature {
   Feature() : order(0), flipTargetSignOnNegScalarProduct(false) {}
   virtual ~Feature() {}
   virtual rai::String shortTag(const rai::KinematicWorld& K) { NIY; }
+  virtual Feature* clone() const { return NULL; } ///< an independent copy (e.g., to evaluate it concurrently), or NULL if not supported
   virtual Graph getSpec(const rai::KinematicWorld& K){ return Graph({{"description", shortTag(K)}}); }
   
   //-- helpers
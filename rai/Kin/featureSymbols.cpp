@@ -4,6 +4,7 @@
 #include <Kin/TM_proxy.h>
 #include <Kin/TM_qItself.h>
 #include <Kin/TM_PairCollision.h>
+#include <Kin/TM_SDFDistance.h>
 #include <Kin/TM_transition.h>
 #include <Kin/TM_qLimits.h>
 #include <Kin/TM_NewtonEuler.h>
@@ -36,6 +37,7 @@ template<> const char* rai::Enum<FeatureSymbol>::names []= {
   "accumulatedCollisions",
   "jointLimits",
   "distance",
+  "sdfDistance",
   "qItself",
   "aboveBox",
   "insideBox",
@@ -59,6 +61,7 @@ double shapeSize(const rai::KinematicWorld& K, const char* name, uint i=2) {
 
 Feature* symbols2feature(FeatureSymbol feat, const StringA& frames, const rai::KinematicWorld& world){
   if(feat==FS_distance) {  return new TM_PairCollision(world, frames(0), frames(1), TM_PairCollision::_negScalar, false); }
+  if(feat==FS_sdfDistance) {  return new TM_SDFDistance(world, frames(0), frames(1)); }
   if(feat==FS_aboveBox) {  return new TM_AboveBox(world, frames(1), frames(0), .05); }
   if(feat==FS_standingAbove) {
     double h = .5*(shapeSize(world, frames(0)) + shapeSize(world, frames(1)));
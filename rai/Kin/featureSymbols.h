@@ -36,6 +36,7 @@ enum FeatureSymbol {
   FS_accumulatedCollisions,
   FS_jointLimits,
   FS_distance,
+  FS_sdfDistance,
 
   FS_qItself,
 
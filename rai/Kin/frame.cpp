@@ -43,11 +43,13 @@ rai::Frame::Frame(KinematicWorld& _K, const Frame* copyFrame)
   K.frames.append(this);
   if(copyFrame) {
     const Frame& f = *copyFrame;
-    name=f.name; Q=f.Q; X=f.X; tau=f.tau; ats=f.ats; active=f.active; flags=f.flags;
+    name=f.name; Q=f.Q; X=f.X; tau=f.tau; _ats=f._ats; active=f.active; flags=f.flags;
     //we cannot copy link! because we can't know if the frames already exist. KinematicWorld::copy copies the rel's !!
     if(copyFrame->joint) new Joint(*this, copyFrame->joint);
     if(copyFrame->shape) new Shape(*this, copyFrame->shape);
     if(copyFrame->inertia) new Inertia(*this, copyFrame->inertia);
+  } else {
+    _ats = std::make_shared<Graph>();
   }
 }
 
@@ -68,6 +70,7 @@ rai::Frame::~Frame() {
   CHECK_EQ(this, K.frames(ID), "")
   K.frames.remove(ID);
   listReindex(K.frames);
+  K.invalidateFrameIndex();
 }
 
 void rai::Frame::calc_X_from_parent() {
@@ -77,14 +80,7 @@ void rai::Frame::calc_X_from_parent() {
   X = from;
   X.appendTransformation(Q);
   CHECK_EQ(X.pos.x, X.pos.x, "NAN transformation:" <<from <<'*' <<Q);
-  if(joint) {
-    Joint *j = joint;
-    if(j->type==JT_hingeX || j->type==JT_transX || j->type==JT_XBall)  j->axis = from.rot.getX();
-    if(j->type==JT_hingeY || j->type==JT_transY)  j->axis = from.rot.getY();
-    if(j->type==JT_hingeZ || j->type==JT_transZ)  j->axis = from.rot.getZ();
-    if(j->type==JT_transXYPhi)  j->axis = from.rot.getZ();
-    if(j->type==JT_phiTransXY)  j->axis = from.rot.getZ();
-  }
+  if(joint) joint->calc_axis_from_parent();
 }
 
 void rai::Frame::calc_Q_from_parent(bool enforceWithinJoint) {
@@ -105,6 +101,11 @@ rai::Inertia &rai::Frame::getInertia() {
   return *inertia;
 }
 
+Graph &rai::Frame::getAts() {
+  if(_ats.use_count()>1) _ats = std::make_shared<Graph>(*_ats);
+  return *_ats;
+}
+
 rai::Frame *rai::Frame::getUpwardLink(rai::Transformation &Qtotal) {
   if(!!Qtotal) Qtotal.setZero();
   Frame *p=this;
@@ -127,7 +128,7 @@ void rai::Frame::read(const Graph& ats) {
     if(ats["B"]){ //there is an extra transform from the joint into this frame -> create an own joint frame
       Frame *f=new Frame(parent);
       f->name <<'|' <<name; //the joint frame is actually the link frame of all child frames
-      f->ats.copy(ats, false, true);
+      f->getAts().copy(ats, false, true);
       this->unLink();
       this->linkFrom(f);
       new Joint(*f);
@@ -166,7 +167,7 @@ void rai::Frame::write(std::ostream& os) const {
     }
   }
   
-  for(Node *n : ats) {
+  for(Node *n : ats()) {
     StringA avoid = {"Q", "pose", "rel", "X", "from", "to", "q", "shape", "joint", "type", "color", "size", "contact", "mesh", "meshscale", "mass", "limits", "ctrl_H", "axis", "A"};
     if(!avoid.contains(n->keys.last())) os <<' ' <<*n;
   }
@@ -369,6 +370,15 @@ void rai::Joint::calc_Q_from_q(const arr &q, uint _qIndex) {
   //    link->link = A * Q * B; //total rel transformation
 }
 
+void rai::Joint::calc_axis_from_parent() {
+  const Transformation &from = frame.parent->X;
+  if(type==JT_hingeX || type==JT_transX || type==JT_XBall)  axis = from.rot.getX();
+  if(type==JT_hingeY || type==JT_transY)  axis = from.rot.getY();
+  if(type==JT_hingeZ || type==JT_transZ)  axis = from.rot.getZ();
+  if(type==JT_transXYPhi)  axis = from.rot.getZ();
+  if(type==JT_phiTransXY)  axis = from.rot.getZ();
+}
+
 arr rai::Joint::calc_q_from_Q(const rai::Transformation &Q) const {
   arr q;
   switch(type) {
@@ -687,8 +697,8 @@ void rai::Joint::write(std::ostream& os) const {
   }
   
   Node *n;
-  if((n=frame.ats["Q"])) os <<*n <<' ';
-  if((n=frame.ats["q"])) os <<*n <<' ';
+  if((n=frame.ats()["Q"])) os <<*n <<' ';
+  if((n=frame.ats()["q"])) os <<*n <<' ';
 }
 
 //===========================================================================
@@ -760,9 +770,9 @@ void rai::Shape::write(std::ostream& os) const {
   }
   
   Node *n;
-  if((n=frame.ats["color"])) os <<' ' <<*n;
-  if((n=frame.ats["mesh"])) os <<' ' <<*n;
-  if((n=frame.ats["meshscale"])) os <<' ' <<*n;
+  if((n=frame.ats()["color"])) os <<' ' <<*n;
+  if((n=frame.ats()["mesh"])) os <<' ' <<*n;
+  if((n=frame.ats()["meshscale"])) os <<' ' <<*n;
   if(cont) os <<" contact, ";
 }
 
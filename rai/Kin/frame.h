@@ -57,7 +57,7 @@ struct Frame : NonCopyable{
   Transformation Q=0;        ///< relative transform to parent
   Transformation X=0;        ///< frame's absolute pose
   double tau=0.;            ///< frame's absolute time (could be thought as part of the transformation X in space-time)
-  Graph ats;                 ///< list of any-type attributes
+  std::shared_ptr<Graph> _ats; ///< list of any-type attributes; shared between copies of a frame until written (use ats() and getAts())
   bool active=true;          ///< if false, this frame is skipped in computations (e.g. in fwd propagation)
   int flags=0;               ///< various flags that are used by task maps to impose costs/constraints in KOMO
   
@@ -80,6 +80,8 @@ struct Frame : NonCopyable{
   void linkFrom(Frame *_parent, bool adoptRelTransform=false);
   
   Inertia& getInertia();
+  const Graph& ats() const { return *_ats; }
+  Graph& getAts(); ///< for writing the attributes: copies them first if they are shared with another frame
   
   void getRigidSubFrames(FrameL& F); ///< recursively collect all rigidly attached sub-frames (e.g., shapes of a link), (THIS is not included)
   Frame* getUpwardLink(rai::Transformation& Qtotal=NoTransformation); ///< recurse upward BEFORE the next joint and return relative transform (this->Q is not included!b)
@@ -123,6 +125,7 @@ struct Joint : NonCopyable{
   
   uint qDim() { return dim; }
   void calc_Q_from_q(const arr& q, uint n);
+  void calc_axis_from_parent(); ///< the world axis, given the parent's X (called by Frame::calc_X_from_parent)
   arr calc_q_from_Q(const Transformation &Q) const;
   arr getScrewMatrix();
   uint getDimFromType() const;
@@ -25,14 +25,18 @@
 #include "uncertainty.h"
 #include "proxy.h"
 #include "kin_swift.h"
+#include "kin_broadphase.h"
 #include "kin_physx.h"
 #include "kin_ode.h"
 #include "kin_feather.h"
 #include <Geo/qhull.h>
+#include <Geo/pairCollision.h>
 #include <GeoOptim/geoOptim.h>
 #include <Gui/opengl.h>
 #include <Algo/algos.h>
+#include <Core/thread.h>
 #include <iomanip>
+#include <unordered_map>
 
 #ifndef RAI_ORS_ONLY_BASICS
 #  include <Core/graph.h>
@@ -61,7 +65,8 @@ void lib_ors() { cout <<"force loading lib/ors" <<endl; }
 
 #ifndef RAI_ORS_ONLY_BASICS
 
-uint rai::KinematicWorld::setJointStateCount = 0;
+std::atomic<uint> rai::KinematicWorld::setJointStateCount(0);
+static std::atomic<uint> activeSetVersions(0);
 
 //===========================================================================
 //
@@ -128,17 +133,145 @@ bool always_unlocked(void*) { return false; }
 //
 
 namespace rai {
+/// memoized results of jacobianPos (per frame and world point) and axesMatrix (per frame); an entry is valid while its
+/// version equals the current one -- invalidation only increments the version, so the entries' memory is reused.
+/// Writes to a frame's X or Q that bypass the KinematicWorld methods don't invalidate: a hit also requires the frame's X and
+/// Q to be the ones the entry was computed with
+struct JacobianCache {
+  struct Entry { uint version=0; bool axes=false; Vector pos; Transformation X, Q; arr J; };
+  std::vector<std::vector<Entry>> entries; ///< per frame ID (std::vector: Entry holds an arr and must not be memmoved)
+  uint version=1;
+  uint hits=0, misses=0;
+  Mutex mutex; ///< features of different objectives may query the same configuration concurrently
+  
+  bool get(arr& J, const Frame *f, bool axes, const Vector& pos, uint N) {
+    auto lock = mutex();
+    if(f->ID<entries.size()) for(Entry& e:entries[f->ID]) {
+        if(e.version==version && e.axes==axes && e.J.d1==N && (axes || e.pos==pos) && e.X==f->X && e.Q==f->Q) {
+          J = e.J;
+          hits++;
+          return true;
+        }
+      }
+    misses++;
+    return false;
+  }
+  
+  void put(const arr& J, const Frame *f, bool axes, const Vector& pos) {
+    auto lock = mutex();
+    if(f->ID>=entries.size()) entries.resize(f->ID+1);
+    Entry *slot=0;
+    for(Entry& e:entries[f->ID]) if(e.version!=version) { slot=&e; break; }
+    if(!slot) { entries[f->ID].emplace_back(); slot = &entries[f->ID].back(); }
+    slot->version = version;
+    slot->axes = axes;
+    slot->pos = pos;
+    slot->X = f->X;
+    slot->Q = f->Q;
+    slot->J = J;
+  }
+};
+
+/// the GJK state of the last PairCollision query per (ordered) frame pair -- successive evaluations of the same configuration
+/// (e.g. in KOMO's optimizer iterations) move the shapes only little, and GJK restarts from the previous simplex
+struct CollisionSeeds {
+  std::unordered_map<uint64_t, PairCollisionSeed> seeds; ///< key: frame IDs a (upper bits) and b
+  uint queries=0, iterations=0;
+  Mutex mutex;
+  
+  static uint64_t key(uint a, uint b) { return (uint64_t(a)<<32) | b; }
+};
+
+/// name->frame index for getFrameByName; lookups verify the name, so renamed frames are only a miss, never a wrong hit --
+/// adding frames via addFrame/addObject updates it, deleting or bulk-renaming frames drops it
+struct FrameIndex {
+  std::unordered_map<std::string, Frame*> map;
+  bool valid=false;
+  uint indexedN=0; ///< frames.N at the last update -- if frames were added by other means, a miss triggers a rebuild
+  Mutex mutex;
+  
+  void build(const FrameL& frames) {
+    map.clear();
+    map.reserve(frames.N);
+    for(Frame *f:frames) map.emplace((const char*)f->name, f); //the first of equal names wins, as with the linear scan
+    indexedN = frames.N;
+    valid = true;
+  }
+  
+  Frame* find(const char* name) {
+    auto it = map.find(name);
+    if(it!=map.end() && it->second->name==name) return it->second;
+    return NULL;
+  }
+};
+
+/// the workers of evalFeatureBatch and kinematicsPosBatch, kept between calls: a thread pool and one copy of the world per
+/// block -- a copy with the world's activeSetVersion only gets the current state restored, others are copied anew
+struct BatchWorkers {
+  ThreadPool *pool=NULL;
+  rai::Array<std::shared_ptr<KinematicWorld>> worlds;
+  WorldState state; ///< (only a buffer)
+  Mutex mutex;      ///< one batch evaluation at a time
+  
+  ~BatchWorkers() { if(pool) delete pool; }
+  
+  void prepare(const KinematicWorld& K, uint blocks) {
+    if(blocks>1 && (!pool || pool->numThreads<blocks)) {
+      if(pool) delete pool;
+      pool = new ThreadPool(blocks);
+    }
+    if(worlds.N<blocks) worlds.resizeCopy(blocks);
+    state.save(K);
+    for(uint b=0; b<blocks; b++) {
+      std::shared_ptr<KinematicWorld>& W = worlds(b);
+      if(W && K.activeSetVersion && W->activeSetVersion==K.activeSetVersion && W->frames.N==K.frames.N) {
+        state.restore(*W);
+        W->copyProxies(K);
+      } else {
+        W = std::make_shared<KinematicWorld>();
+        W->copy(K);
+        W->useIncrementalFK = true; //the copies are only written via setJointState (and WorldState::restore)
+      }
+    }
+  }
+};
+
 struct sKinematicWorld {
   OpenGL *gl;
   SwiftInterface *swift;
+  BroadphaseInterface *broadphase = NULL;
   PhysXInterface *physx;
   OdeInterface *ode;
   FeatherstoneInterface *fs = NULL;
   bool swiftIsReference;
+  JacobianCache jacobians;
+  FrameIndex frameIndex;
+  CollisionSeeds collisionSeeds;
+  BatchWorkers batch;
+  Array<JointL> fk_qJoints; ///< (per q-index) the joints it parameterizes (several with mimic joints), built by a full calc_fwdPropagateChanged
+  uintA fk_order;      ///< (per frame ID) the position in fwdActiveSet
+  JointL fk_changed;   ///< joints whose q was changed by setJointState since the last calc_fwdPropagateChanged
+  boolA fk_dirty;      ///< (per frame ID) the frames of these joints, and below them during the propagation
+  bool fk_unknown=true; ///< q was changed other than through setJointState's marking: propagate fully
+  uint fk_version=0;   ///< the jacobians.version right after the last calc_fwdPropagateChanged -- any other state change increments it
+  
+  /// called by setJointState before q is overwritten: marks the joints whose entries differ between K.q and q_new -- or, if
+  /// the last propagation isn't current anymore, that a full one is needed
+  void markChanged(const KinematicWorld& K, const arr& q_new) {
+    if(fk_unknown || fk_version!=jacobians.version || K.q.p==q_new.p || K.q.N!=q_new.N
+        || fk_qJoints.N!=q_new.N || fk_dirty.N!=K.frames.N) { fk_unknown=true; return; }
+    for(uint i=0; i<q_new.N; i++) if(K.q.p[i]!=q_new.p[i]) {
+      for(Joint *j:fk_qJoints.p[i]) if(!fk_dirty.p[j->frame.ID]) {
+        fk_dirty.p[j->frame.ID]=true;
+        fk_changed.append(j);
+      }
+    }
+  }
   sKinematicWorld():gl(NULL), swift(NULL), physx(NULL), ode(NULL), swiftIsReference(false) {}
   ~sKinematicWorld() {
     if(gl) delete gl;
     if(swift && !swiftIsReference) delete swift;
+    if(broadphase) delete broadphase;
     if(physx) delete physx;
     if(ode) delete ode;
   }
@@ -181,6 +314,7 @@ void rai::KinematicWorld::addFile(const char* filename) {
 rai::Frame* rai::KinematicWorld::addFrame(const char* name, const char* parent, const char* args){
   rai::Frame *f = new rai::Frame(*this);
   f->name = name;
+  indexFrameName(f);
 
   if(parent){
     rai::Frame *p = getFrameByName(parent);
@@ -188,8 +322,8 @@ rai::Frame* rai::KinematicWorld::addFrame(const char* name, const char* parent,
   }
 
   if(args){
-    rai::String(args) >>f->ats;
-    f->read(f->ats);
+    rai::String(args) >>f->getAts();
+    f->read(f->ats());
   }
 
   if(f->parent) f->X = f->parent->X * f->Q;
@@ -224,6 +358,7 @@ rai::Frame* rai::KinematicWorld::addObject(rai::ShapeType shape, const arr& size
 rai::Frame* rai::KinematicWorld::addObject(const char* name, rai::ShapeType shape, const arr& size, const arr& col, double radius, const char* parent, const arr& pos, const arr& rot){
   rai::Frame *f = addObject(shape, size, col, radius);
   f->name=name;
+  indexFrameName(f);
 
   if(parent){
     rai::Frame *p = getFrameByName(parent);
@@ -247,10 +382,12 @@ void rai::KinematicWorld::clear() {
 }
 
 void rai::KinematicWorld::reset_q() {
+  invalidateJacobianCache();
   q.clear();
   qdot.clear();
   fwdActiveSet.clear();
   fwdActiveJoints.clear();
+  activeSetVersion=0;
 }
 
 FrameL rai::KinematicWorld::calc_topSort() {
@@ -288,12 +425,14 @@ bool rai::KinematicWorld::check_topSort() {
 }
 
 void rai::KinematicWorld::calc_activeSets() {
+  invalidateJacobianCache();
   if(!check_topSort()) {
     fwdActiveSet = calc_topSort(); //graphGetTopsortOrder<Frame>(frames);
   }
   fwdActiveJoints.clear();
   for(Frame *f:fwdActiveSet) if(f->joint && f->joint->active)
     fwdActiveJoints.append(f->joint);
+  activeSetVersion = ++activeSetVersions;
 }
 
 void rai::KinematicWorld::calc_q() {
@@ -316,6 +455,17 @@ void rai::KinematicWorld::copy(const rai::KinematicWorld& K, bool referenceSwift
 //  for(Proxy& p:proxies) { p.a = frames(p.a->ID); p.b = frames(p.b->ID);  p.coll.reset(); }
   //copy contacts
   for(Contact *c:K.contacts) new Contact(*frames(c->a.ID), *frames(c->b.ID), c);
+  //copy the name index, if it is complete
+  {
+    auto lock = K.s->frameIndex.mutex();
+    if(K.s->frameIndex.valid && K.s->frameIndex.indexedN==K.frames.N) {
+      s->frameIndex.map.clear();
+      s->frameIndex.map.reserve(K.s->frameIndex.map.size());
+      for(auto& e:K.s->frameIndex.map) s->frameIndex.map.emplace(e.first, frames(e.second->ID));
+      s->frameIndex.indexedN = frames.N;
+      s->frameIndex.valid = true;
+    }
+  }
   //copy swift reference
   if(referenceSwiftOnCopy) {
     s->swift = K.s->swift;
@@ -324,14 +474,97 @@ void rai::KinematicWorld::copy(const rai::KinematicWorld& K, bool referenceSwift
   q = K.q;
   qdot = K.qdot;
   calc_activeSets();
+  activeSetVersion = K.activeSetVersion; //same structure
 }
 
 bool rai::KinematicWorld::operator!() const { return this==&NoWorld; }
 
+static void getArr7d(double *p, const rai::Transformation& t) {
+  p[0]=t.pos.x; p[1]=t.pos.y; p[2]=t.pos.z;
+  p[3]=t.rot.w; p[4]=t.rot.x; p[5]=t.rot.y; p[6]=t.rot.z;
+}
+
+void rai::WorldState::save(const KinematicWorld& K) {
+  activeSetVersion = K.activeSetVersion;
+  q = K.q;
+  qdot = K.qdot;
+  X.resize(K.frames.N, 7);
+  Q.resize(K.frames.N, 7);
+  for(uint i=0; i<K.frames.N; i++) {
+    getArr7d(&X(i, 0), K.frames.p[i]->X);
+    getArr7d(&Q(i, 0), K.frames.p[i]->Q);
+  }
+  contactFrames.resize(K.contacts.N, 2);
+  contactSoft.resize(K.contacts.N);
+  for(uint i=0; i<K.contacts.N; i++) {
+    Contact *c = K.contacts.p[i];
+    contactFrames(i, 0) = c->a.ID;
+    contactFrames(i, 1) = c->b.ID;
+    contactSoft(i) = c->soft;
+  }
+}
+
+void rai::WorldState::restore(KinematicWorld& K) const {
+  CHECK_EQ(X.d0, K.frames.N, "the world's frames changed since the state was saved");
+  
+  //-- the structure is only checked (and the contacts recreated) if the world's active sets differ from the saved ones
+  bool sameStructure = activeSetVersion && K.activeSetVersion==activeSetVersion && K.fwdActiveSet.N==K.frames.N;
+  if(!sameStructure) {
+    bool sameContacts = (K.contacts.N==contactFrames.d0);
+    for(uint i=0; sameContacts && i<K.contacts.N; i++)
+      sameContacts = (K.contacts(i)->a.ID==contactFrames(i, 0) && K.contacts(i)->b.ID==contactFrames(i, 1));
+    if(!sameContacts) {
+      while(K.contacts.N) delete K.contacts.last();
+      for(uint i=0; i<contactFrames.d0; i++) new Contact(*K.frames(contactFrames(i, 0)), *K.frames(contactFrames(i, 1)));
+    }
+  }
+  
+  for(uint i=0; i<X.d0; i++) {
+    Frame *f = K.frames.p[i];
+    f->X.pos.set(&X(i, 0));  f->X.rot.set(&X(i, 3));
+    f->Q.pos.set(&Q(i, 0));  f->Q.rot.set(&Q(i, 3));
+  }
+  for(Frame *f:K.frames) if(f->joint && f->parent) f->joint->calc_axis_from_parent();
+  
+  if(!sameStructure) {
+    K.calc_q();
+    CHECK_EQ(K.q.N, q.N, "the world's joints changed since the state was saved");
+  }
+  K.q = q;
+  K.qdot = qdot;
+  for(uint i=0; i<K.contacts.N; i++) {
+    Contact *c = K.contacts.p[i];
+    c->calc_F_from_q(K.q, c->qIndex);
+    c->soft = contactSoft(i);
+  }
+  K.invalidateJacobianCache();
+}
+
+void rai::WorldState::write(std::ostream& os) const {
+  os <<"WorldState " <<activeSetVersion <<'\n';
+  q.writeTagged(os, "q", true);
+  qdot.writeTagged(os, "qdot", true);
+  X.writeTagged(os, "X", true);
+  Q.writeTagged(os, "Q", true);
+  contactFrames.writeTagged(os, "contactFrames", true);
+  contactSoft.writeTagged(os, "contactSoft", true);
+}
+
+void rai::WorldState::read(std::istream& is) {
+  is >>PARSE("WorldState") >>activeSetVersion;
+  q.readTagged(is, "q");
+  qdot.readTagged(is, "qdot");
+  X.readTagged(is, "X");
+  Q.readTagged(is, "Q");
+  contactFrames.readTagged(is, "contactFrames");
+  contactSoft.readTagged(is, "contactSoft");
+}
+
 /** @brief KINEMATICS: given the (absolute) frames of root nodes and the relative frames
     on the edges, this calculates the absolute frames of all other nodes (propagating forward
     through trees and testing consistency of loops). */
 void rai::KinematicWorld::calc_fwdPropagateFrames() {
+  invalidateJacobianCache();
   if(fwdActiveSet.N!=frames.N) calc_activeSets();
   for(Frame *f:fwdActiveSet) {
 #if 1
@@ -356,6 +589,52 @@ void rai::KinematicWorld::calc_fwdPropagateFrames() {
   }
 }
 
+void rai::KinematicWorld::calc_fwdPropagateChanged() {
+  bool incremental = useIncrementalFK && !s->fk_unknown
+                     && s->fk_version==s->jacobians.version //no other state change since the last call
+                     && s->fk_qJoints.N==q.N && s->fk_dirty.N==frames.N && fwdActiveSet.N==frames.N;
+  if(!incremental) {
+    calc_Q_from_q();
+    calc_fwdPropagateFrames();
+    s->fk_qJoints.resize(q.N);
+    for(JointL& J:s->fk_qJoints) J.clear();
+    for(Joint *j: fwdActiveJoints) {
+      uint d = j->mimic ? j->mimic->dim : j->dim;
+      if(j->uncertainty) d *= 2;
+      for(uint i=j->qIndex; i<j->qIndex+d && i<q.N; i++) s->fk_qJoints(i).append(j);
+    }
+    s->fk_order.resize(frames.N);
+    for(uint i=0; i<fwdActiveSet.N; i++) s->fk_order(fwdActiveSet.p[i]->ID) = i;
+    s->fk_unknown = false;
+  } else if(s->fk_changed.N) {
+    invalidateJacobianCache();
+    boolA& dirty = s->fk_dirty;
+    uint start=fwdActiveSet.N;
+    for(Joint *j: s->fk_changed) {
+      j->calc_Q_from_q(q, j->qIndex);
+      if(j->uncertainty) j->uncertainty->sigma = q.sub(j->qIndex+j->dim, j->qIndex+2*j->dim-1);
+      uint o = s->fk_order(j->frame.ID);
+      if(o<start) start=o;
+    }
+    for(Contact *c: contacts) c->calc_F_from_q(q, c->qIndex);
+    //fwdActiveSet is sorted parents-first: dirtiness propagates down the subtrees of the changed joints
+    for(uint i=start; i<fwdActiveSet.N; i++) {
+      Frame *f = fwdActiveSet.p[i];
+      if(!dirty.p[f->ID]) {
+        if(!f->parent || !dirty.p[f->parent->ID]) continue;
+        dirty.p[f->ID] = true;
+      }
+      if(f->parent) f->calc_X_from_parent();
+    }
+  } else {
+    for(Contact *c: contacts) c->calc_F_from_q(q, c->qIndex);
+  }
+  s->fk_changed.clear();
+  s->fk_dirty.resize(frames.N);
+  s->fk_dirty = false;
+  s->fk_version = s->jacobians.version;
+}
+
 arr rai::KinematicWorld::calc_fwdPropagateVelocities() {
   if(fwdActiveSet.N!=frames.N) calc_activeSets();
   arr vel(frames.N, 2, 3);  //for every frame we have a linVel and angVel, each 3D
@@ -415,6 +694,7 @@ void rai::KinematicWorld::calc_Q_from_BodyFrames() {
   for(Frame *f:frames) if(f->parent) {
     f->Q.setDifference(f->parent->X, f->X);
   }
+  invalidateJacobianCache();
 }
 
 arr rai::KinematicWorld::naturalQmetric(double power) const {
@@ -556,8 +836,11 @@ arr rai::KinematicWorld::getJointState(const uintA& joints) const {
 
 arr rai::KinematicWorld::getFrameState() const{
   arr X(frames.N, 7);
-  for(uint i=0; i<X.d0; i++) {
-    X[i] = frames(i)->X.getArr7d();
+  for(uint i=0; i<X.d0; i++) { //(directly, without a 7d temporary per frame)
+    const rai::Transformation& f = frames(i)->X;
+    double *x = X.p+7*i;
+    x[0]=f.pos.x; x[1]=f.pos.y; x[2]=f.pos.z;
+    x[3]=f.rot.w; x[4]=f.rot.x; x[5]=f.rot.y; x[6]=f.rot.z;
   }
   return X;
 }
@@ -585,6 +868,7 @@ arr rai::KinematicWorld::getLimits() const {
 }
 
 void rai::KinematicWorld::calc_q_from_Q() {
+  invalidateJacobianCache();
   uint N=q.N;
   if(!N) N=analyzeJointStateDimensions();
   q.resize(N).setZero();
@@ -615,6 +899,7 @@ void rai::KinematicWorld::calc_q_from_Q() {
 }
 
 void rai::KinematicWorld::calc_Q_from_q() {
+  invalidateJacobianCache();
   uint n=0;
   for(Joint *j: fwdActiveJoints) {
     if(!j->mimic) CHECK_EQ(j->qIndex, n, "joint indexing is inconsistent");
@@ -641,10 +926,10 @@ void rai::KinematicWorld::selectJointsByGroup(const StringA &groupNames, bool On
     bool select;
     if(OnlyTheseOrNotThese) { //only these
       select=false;
-      for(const String& s:groupNames) if(f->ats[s]) { select=true; break; }
+      for(const String& s:groupNames) if(f->ats()[s]) { select=true; break; }
     } else {
       select=true;
-      for(const String& s:groupNames) if(f->ats[s]) { select=false; break; }
+      for(const String& s:groupNames) if(f->ats()[s]) { select=false; break; }
     }
     if(select) f->joint->active=true;
     else  f->joint->active=false;
@@ -687,17 +972,16 @@ void rai::KinematicWorld::setJointState(const arr& _q, const arr& _qdot) {
   if(!!_qdot) CHECK_EQ(_qdot.N, N, "wrong joint velocity dimensionalities");
 #endif
 
+  s->markChanged(*this, _q);
   q=_q;
   if(!!_qdot) qdot=_qdot; else qdot.clear();
   
-  calc_Q_from_q();
-  
-  calc_fwdPropagateFrames();
+  calc_fwdPropagateChanged();
 }
 
 void rai::KinematicWorld::setJointState(const arr& _q, const StringA& joints) {
   setJointStateCount++; //global counter
-  getJointState();
+  arr q_new = getJointState();
   
   CHECK_EQ(_q.N, joints.N, "");
   for(uint i=0; i<_q.N; i++) {
@@ -705,42 +989,43 @@ void rai::KinematicWorld::setJointState(const arr& _q, const StringA& joints) {
     if(frameName(-2)!=':'){ //1-dim joint
       rai::Joint *j = getFrameByName(frameName)->joint;
       CHECK(j, "frame '" <<frameName <<"' is not a joint!");
-      q(j->qIndex) = _q(i);
+      q_new(j->qIndex) = _q(i);
     }else{
       frameName.resize(frameName.N-2, true);
       rai::Joint *j = getFrameByName(frameName)->joint;
       CHECK(j, "frame '" <<frameName <<"' is not a joint!");
-      for(uint k=0;k<j->dim;k++) q(j->qIndex+k) = _q(i+k);
+      for(uint k=0;k<j->dim;k++) q_new(j->qIndex+k) = _q(i+k);
       i += j->dim-1;
     }
   }
+  s->markChanged(*this, q_new);
+  q = q_new;
   qdot.clear();
   
-  calc_Q_from_q();
-  
-  calc_fwdPropagateFrames();
+  calc_fwdPropagateChanged();
 }
 
 void rai::KinematicWorld::setJointState(const arr& _q, const uintA& joints) {
   setJointStateCount++; //global counter
-  getJointState();
+  arr q_new = getJointState();
 
   uint nd=0;
   for(uint i=0; i<joints.N; i++) {
     rai::Joint *j = frames(joints(i))->joint;
     if(!j || !j->active) continue;
-    for(uint ii=0;ii<j->dim;ii++) q(j->qIndex+ii) = _q(nd+ii);
+    for(uint ii=0;ii<j->dim;ii++) q_new(j->qIndex+ii) = _q(nd+ii);
     nd += j->dim;
   }
   CHECK_EQ(_q.N, nd, "");
+  s->markChanged(*this, q_new);
+  q = q_new;
   qdot.clear();
 
-  calc_Q_from_q();
-
-  calc_fwdPropagateFrames();
+  calc_fwdPropagateChanged();
 }
 
 void rai::KinematicWorld::setFrameState(const arr& X, const StringA& frameNames, bool calc_q_from_X){
+  invalidateJacobianCache();
   if(!frameNames.N){
     if(X.d0 > frames.N) LOG(-1) <<"X.d0=" <<X.d0 <<" is larger than frames.N=" <<frames.N;
     if(X.d0 < frames.N) LOG(-1) <<"X.d0=" <<X.d0 <<" is smaller than frames.N=" <<frames.N;
@@ -757,8 +1042,9 @@ void rai::KinematicWorld::setFrameState(const arr& X, const StringA& frameNames,
       f->X.rot.normalize();
     }else{
       CHECK_EQ(X.d0, frameNames.N, "X.d0 does not equal #frames");
+      FrameL F = getFramesByNames(frameNames);
       for(uint i=0;i<X.d0;i++){
-        rai::Frame *f = getFrameByName(frameNames(i));
+        rai::Frame *f = F(i);
         if(!f) return;
         f->X.set(X[i]);
         f->X.rot.normalize();
@@ -786,6 +1072,82 @@ void rai::KinematicWorld::evalFeature(arr& y, arr& J, FeatureSymbol fs, const St
   delete f;
 }
 
+/* The rows of Qs are distributed in contiguous blocks over the workers. Each block evaluates on its own copy of this
+   world (so consecutive rows profit from the incremental forward kinematics and the Jacobian cache) and with its own
+   Feature objects: a Feature may carry internal state and is never evaluated concurrently. The thread pool and the copies
+   are kept for the next call (see BatchWorkers). */
+void rai::KinematicWorld::evalFeatureBatch(arr& Y, arr& J, const arr& Qs, const rai::Array<FeatureSymbol>& fs, const rai::Array<StringA>& symbols, uint threads) const {
+  CHECK_EQ(fs.N, symbols.N, "one symbol list per feature");
+  CHECK_EQ(Qs.nd, 2, "the joint states need to be the rows of a matrix");
+  CHECK_EQ(Qs.d1, getJointStateDimension(), "");
+  uint n=Qs.d0, blocks=threads;
+  if(blocks>n) blocks=n;
+  if(!blocks) blocks=1;
+  
+  //-- copies and features are prepared here: copying and the Feature constructors are not thread safe
+  BatchWorkers& B = s->batch;
+  auto lock = B.mutex();
+  B.prepare(*this, blocks);
+  rai::Array<std::shared_ptr<Feature>> features(blocks, fs.N);
+  uintA dims(fs.N);
+  for(uint b=0; b<blocks; b++) {
+    for(uint i=0; i<fs.N; i++) features(b, i) = std::shared_ptr<Feature>(symbols2feature(fs(i), symbols(i), *B.worlds(b)));
+  }
+  uint D=0;
+  for(uint i=0; i<fs.N; i++) { dims(i) = features(0, i)->dim_phi(*B.worlds(0)); D += dims(i); }
+  
+  Y.resize(n, D);
+  if(!!J) J.resize(n, D, Qs.d1);
+  auto evalBlock = [&](uint b, uint worker) {
+    KinematicWorld& K = *B.worlds(b);
+    arr y, Jy;
+    for(uint r=(b*n)/blocks; r<((b+1)*n)/blocks; r++) {
+      K.setJointState(Qs[r]);
+      uint d=0;
+      for(uint i=0; i<fs.N; i++) {
+        features(b, i)->phi(y, (!!J?Jy:NoArr), K);
+        CHECK_EQ(y.N, dims(i), "batch evaluation requires features of constant dimension");
+        memmove(&Y(r, d), y.p, y.N*sizeof(double));
+        if(!!J) { CHECK_EQ(Jy.N, y.N*J.d2, "dense Jacobians expected"); memmove(&J(r, d, 0), Jy.p, Jy.N*sizeof(double)); }
+        d += y.N;
+      }
+    }
+  };
+  if(blocks>1) B.pool->run(blocks, evalBlock);
+  else evalBlock(0, 0);
+}
+
+void rai::KinematicWorld::kinematicsPosBatch(arr& Y, arr& J, const arr& Qs, const FrameL& F, uint threads) const {
+  CHECK_EQ(Qs.nd, 2, "the joint states need to be the rows of a matrix");
+  CHECK_EQ(Qs.d1, getJointStateDimension(), "");
+  uint n=Qs.d0, blocks=threads;
+  if(blocks>n) blocks=n;
+  if(!blocks) blocks=1;
+  
+  uintA ids(F.N);
+  for(uint i=0; i<F.N; i++) { CHECK_EQ(F(i), frames(F(i)->ID), "frame is not part of this world"); ids(i) = F(i)->ID; }
+  BatchWorkers& B = s->batch;
+  auto lock = B.mutex();
+  B.prepare(*this, blocks);
+  
+  Y.resize(n, F.N, 3);
+  if(!!J) J.resize(n, 3*F.N, Qs.d1);
+  auto evalBlock = [&](uint b, uint worker) {
+    KinematicWorld& K = *B.worlds(b);
+    arr y, Jy;
+    for(uint r=(b*n)/blocks; r<((b+1)*n)/blocks; r++) {
+      K.setJointState(Qs[r]);
+      for(uint i=0; i<ids.N; i++) {
+        K.kinematicsPos(y, (!!J?Jy:NoArr), K.frames(ids(i)));
+        memmove(&Y(r, i, 0), y.p, 3*sizeof(double));
+        if(!!J) { CHECK_EQ(Jy.N, 3*J.d2, "dense Jacobians expected"); memmove(&J(r, 3*i, 0), Jy.p, Jy.N*sizeof(double)); }
+      }
+    }
+  };
+  if(blocks>1) B.pool->run(blocks, evalBlock);
+  else evalBlock(0, 0);
+}
+
 //===========================================================================
 //
 // core: kinematics and dynamics
@@ -813,74 +1175,104 @@ void rai::KinematicWorld::kinematicsPos(arr& y, arr& J, Frame *a, const rai::Vec
 }
 
 #if 1
+/// adds the position Jacobian of joint j (of frame a) at pos_world to the columns col,.. of J
+static void addJointPosColumns(arr& J, uint col, rai::Joint *j, rai::Frame *a, const rai::Vector& pos_world, const arr& q) {
+  using namespace rai;
+  if(j->type==JT_hingeX || j->type==JT_hingeY || j->type==JT_hingeZ) {
+    rai::Vector tmp = j->axis ^ (pos_world-j->X()*j->Q().pos);
+    J(0, col) += tmp.x;
+    J(1, col) += tmp.y;
+    J(2, col) += tmp.z;
+  } else if(j->type==JT_transX || j->type==JT_transY || j->type==JT_transZ || j->type==JT_XBall) {
+    J(0, col) += j->axis.x;
+    J(1, col) += j->axis.y;
+    J(2, col) += j->axis.z;
+  } else if(j->type==JT_transXY) {
+    if(j->mimic) NIY;
+    arr R = j->X().rot.getArr();
+    J.setMatrixBlock(R.sub(0,-1,0,1), 0, col);
+  } else if(j->type==JT_transXYPhi) {
+    if(j->mimic) NIY;
+    arr R = j->X().rot.getArr();
+    J.setMatrixBlock(R.sub(0,-1,0,1), 0, col);
+    rai::Vector tmp = j->axis ^ (pos_world-(j->X().pos + j->X().rot*a->Q.pos));
+    J(0, col+2) += tmp.x;
+    J(1, col+2) += tmp.y;
+    J(2, col+2) += tmp.z;
+  } else if(j->type==JT_phiTransXY) {
+    if(j->mimic) NIY;
+    rai::Vector tmp = j->axis ^ (pos_world-j->X().pos);
+    J(0, col) += tmp.x;
+    J(1, col) += tmp.y;
+    J(2, col) += tmp.z;
+    arr R = (j->X().rot*a->Q.rot).getArr();
+    J.setMatrixBlock(R.sub(0,-1,0,1), 0, col+1);
+  }
+  if(j->type==JT_XBall) {
+    if(j->mimic) NIY;
+    arr R = conv_vec2arr(j->X().rot.getX());
+    R.reshape(3,1);
+    J.setMatrixBlock(R, 0, col);
+  }
+  if(j->type==JT_trans3 || j->type==JT_free) {
+    if(j->mimic) NIY;
+    arr R = j->X().rot.getArr();
+    J.setMatrixBlock(R, 0, col);
+  }
+  if(j->type==JT_quatBall || j->type==JT_free || j->type==JT_XBall) {
+    uint offset = 0;
+    if(j->type==JT_XBall) offset=1;
+    if(j->type==JT_free) offset=3;
+    arr Jrot = j->X().rot.getArr() * a->Q.rot.getJacobian(); //transform w-vectors into world coordinate
+    Jrot = crossProduct(Jrot, conv_vec2arr(pos_world-(j->X().pos+j->X().rot*a->Q.pos)));  //cross-product of all 4 w-vectors with lever
+    Jrot /= sqrt(sumOfSqr(q({j->qIndex+offset, j->qIndex+offset+3})));   //account for the potential non-normalization of q
+//          for(uint i=0;i<4;i++) for(uint k=0;k<3;k++) J(k,j_idx+offset+i) += Jrot(k,i);
+    J.setMatrixBlock(Jrot, 0, col+offset);
+  }
+}
+
 void rai::KinematicWorld::jacobianPos(arr& J, Frame *a, const rai::Vector& pos_world) const {
   CHECK_EQ(&a->K, this, "");
 
   //get Jacobian
   uint N=getJointStateDimension();
+  if(useJacobianCache && s->jacobians.get(J, a, false, pos_world, N)) return;
   J.resize(3, N).setZero();
+  Frame *f=a;
   while(a) { //loop backward down the kinematic tree
     if(!a->parent) break; //frame has no inlink -> done
     Joint *j=a->joint;
     if(j && j->active) {
       uint j_idx=j->qIndex;
       if(j_idx>=N) CHECK_EQ(j->type, JT_rigid, "");
-      if(j_idx<N) {
-        if(j->type==JT_hingeX || j->type==JT_hingeY || j->type==JT_hingeZ) {
-          rai::Vector tmp = j->axis ^ (pos_world-j->X()*j->Q().pos);
-          J(0, j_idx) += tmp.x;
-          J(1, j_idx) += tmp.y;
-          J(2, j_idx) += tmp.z;
-        } else if(j->type==JT_transX || j->type==JT_transY || j->type==JT_transZ || j->type==JT_XBall) {
-          J(0, j_idx) += j->axis.x;
-          J(1, j_idx) += j->axis.y;
-          J(2, j_idx) += j->axis.z;
-        } else if(j->type==JT_transXY) {
-          if(j->mimic) NIY;
-          arr R = j->X().rot.getArr();
-          J.setMatrixBlock(R.sub(0,-1,0,1), 0, j_idx);
-        } else if(j->type==JT_transXYPhi) {
-          if(j->mimic) NIY;
-          arr R = j->X().rot.getArr();
-          J.setMatrixBlock(R.sub(0,-1,0,1), 0, j_idx);
-          rai::Vector tmp = j->axis ^ (pos_world-(j->X().pos + j->X().rot*a->Q.pos));
-          J(0, j_idx+2) += tmp.x;
-          J(1, j_idx+2) += tmp.y;
-          J(2, j_idx+2) += tmp.z;
-        } else if(j->type==JT_phiTransXY) {
-          if(j->mimic) NIY;
-          rai::Vector tmp = j->axis ^ (pos_world-j->X().pos);
-          J(0, j_idx) += tmp.x;
-          J(1, j_idx) += tmp.y;
-          J(2, j_idx) += tmp.z;
-          arr R = (j->X().rot*a->Q.rot).getArr();
-          J.setMatrixBlock(R.sub(0,-1,0,1), 0, j_idx+1);
-        }
-        if(j->type==JT_XBall) {
-          if(j->mimic) NIY;
-          arr R = conv_vec2arr(j->X().rot.getX());
-          R.reshape(3,1);
-          J.setMatrixBlock(R, 0, j_idx);
-        }
-        if(j->type==JT_trans3 || j->type==JT_free) {
-          if(j->mimic) NIY;
-          arr R = j->X().rot.getArr();
-          J.setMatrixBlock(R, 0, j_idx);
-        }
-        if(j->type==JT_quatBall || j->type==JT_free || j->type==JT_XBall) {
-          uint offset = 0;
-          if(j->type==JT_XBall) offset=1;
-          if(j->type==JT_free) offset=3;
-          arr Jrot = j->X().rot.getArr() * a->Q.rot.getJacobian(); //transform w-vectors into world coordinate
-          Jrot = crossProduct(Jrot, conv_vec2arr(pos_world-(j->X().pos+j->X().rot*a->Q.pos)));  //cross-product of all 4 w-vectors with lever
-          Jrot /= sqrt(sumOfSqr(q({j->qIndex+offset, j->qIndex+offset+3})));   //account for the potential non-normalization of q
-//          for(uint i=0;i<4;i++) for(uint k=0;k<3;k++) J(k,j_idx+offset+i) += Jrot(k,i);
-          J.setMatrixBlock(Jrot, 0, j_idx+offset);
-        }
-      }
+      if(j_idx<N) addJointPosColumns(J, j_idx, j, a, pos_world, q);
     }
     a = a->parent;
   }
+  if(useJacobianCache) s->jacobians.put(J, f, false, pos_world);
+}
+
+void rai::KinematicWorld::jacobianPos(arr& J, uintA& cols, Frame *a, const rai::Vector& pos_world) const {
+  CHECK_EQ(&a->K, this, "");
+
+  uint N=getJointStateDimension();
+  uint n=0;
+  for(Frame *b=a; b && b->parent; b=b->parent) {
+    Joint *j=b->joint;
+    if(j && j->active && j->qIndex<N) n += (j->mimic ? j->mimic->dim : j->dim);
+  }
+  J.resize(3, n).setZero();
+  cols.resize(n);
+  n=0;
+  for(; a && a->parent; a=a->parent) { //loop backward down the kinematic tree
+    Joint *j=a->joint;
+    if(j && j->active && j->qIndex<N) {
+      uint d = (j->mimic ? j->mimic->dim : j->dim);
+      for(uint i=0; i<d; i++) cols(n+i) = j->qIndex+i;
+      addJointPosColumns(J, n, j, a, pos_world, q);
+      n += d;
+    }
+  }
 }
 
 #else
@@ -1105,7 +1497,9 @@ void rai::KinematicWorld::kinematicsQuat(arr& y, arr& J, Frame *a) const { //TOD
 //* This Jacobian directly gives the implied rotation vector: multiplied with \dot q it gives the angular velocity of body b */
 void rai::KinematicWorld::axesMatrix(arr& J, Frame *a) const {
   uint N = getJointStateDimension();
+  if(useJacobianCache && s->jacobians.get(J, a, true, rai::Vector(0.,0.,0.), N)) return;
   J.resize(3, N).setZero();
+  Frame *f=a;
   
   while(a) { //loop backward down the kinematic tree
     Joint *j=a->joint;
@@ -1133,6 +1527,38 @@ void rai::KinematicWorld::axesMatrix(arr& J, Frame *a) const {
     }
     a = a->parent;
   }
+  if(useJacobianCache) s->jacobians.put(J, f, true, rai::Vector(0.,0.,0.));
+}
+
+void rai::KinematicWorld::invalidateJacobianCache() {
+  if(s) s->jacobians.version++; //(s is deleted before the frames)
+}
+
+void rai::KinematicWorld::getJacobianCacheCounts(uint& hits, uint& misses) const {
+  auto lock = s->jacobians.mutex();
+  hits = s->jacobians.hits;
+  misses = s->jacobians.misses;
+}
+
+bool rai::KinematicWorld::getCollisionSeed(PairCollisionSeed& seed, uint a, uint b) const {
+  auto lock = s->collisionSeeds.mutex();
+  auto it = s->collisionSeeds.seeds.find(CollisionSeeds::key(a, b));
+  if(it==s->collisionSeeds.seeds.end()) return false;
+  seed = it->second;
+  return true;
+}
+
+void rai::KinematicWorld::putCollisionSeed(const PairCollisionSeed& seed, uint a, uint b, uint iterations) const {
+  auto lock = s->collisionSeeds.mutex();
+  s->collisionSeeds.seeds[CollisionSeeds::key(a, b)] = seed;
+  s->collisionSeeds.queries++;
+  s->collisionSeeds.iterations += iterations;
+}
+
+void rai::KinematicWorld::getCollisionIterationCounts(uint& queries, uint& iterations) const {
+  auto lock = s->collisionSeeds.mutex();
+  queries = s->collisionSeeds.queries;
+  iterations = s->collisionSeeds.iterations;
 }
 
 /// The position vec1, attached to b1, relative to the frame of b2 (plus vec2)
@@ -1145,7 +1571,7 @@ void rai::KinematicWorld::kinematicsRelPos(arr& y, arr& J, Frame *a, const rai::
   if(!!J) {
     arr A;
     axesMatrix(A, b);
-    J = Rinv * (J1 - J2 - crossProduct(A, y1 - y2));
+    J = Rinv * (std::move(J1) - J2 - crossProduct(A, y1 - y2)); //(J1 is dead: updated in place)
   }
 }
 
@@ -1159,7 +1585,7 @@ void rai::KinematicWorld::kinematicsRelVec(arr& y, arr& J, Frame *a, const rai::
   if(!!J) {
     arr A;
     axesMatrix(A, b);
-    J = Rinv * (J1 - crossProduct(A, y1));
+    J = Rinv * (std::move(J1) - crossProduct(A, y1));
   }
 }
 
@@ -1303,12 +1729,53 @@ bool rai::KinematicWorld::checkUniqueNames() const {
 
 /// find body with specific name
 rai::Frame* rai::KinematicWorld::getFrameByName(const char* name, bool warnIfNotExist) const {
-  for(Frame *b: frames) if(b->name==name) return b;
+  FrameIndex& I = s->frameIndex;
+  auto lock = I.mutex();
+  if(!I.valid) I.build(frames);
+  Frame *f = I.find(name);
+  if(f) return f;
+  if(I.indexedN!=frames.N) { //frames were added since: rebuild
+    I.build(frames);
+    f = I.find(name);
+    if(f) return f;
+  }
+  //a frame that was renamed after indexing
+  for(Frame *b: frames) if(b->name==name) { I.map[name]=b; return b; }
   if(strcmp("glCamera", name)!=0)
     if(warnIfNotExist) RAI_MSG("cannot find Body named '" <<name <<"' in Graph");
   return 0;
 }
 
+FrameL rai::KinematicWorld::getFramesByNames(const StringA& names, bool warnIfNotExist) const {
+  FrameL F(names.N);
+  for(uint i=0; i<names.N; i++) F(i) = getFrameByName(names(i), warnIfNotExist);
+  return F;
+}
+
+uintA rai::KinematicWorld::getFrameIDs(const StringA& names) const {
+  uintA I(names.N);
+  for(uint i=0; i<names.N; i++) {
+    Frame *f = getFrameByName(names(i), false);
+    if(!f) HALT("frame name '" <<names(i) <<"' doesn't exist");
+    I(i) = f->ID;
+  }
+  return I;
+}
+
+void rai::KinematicWorld::indexFrameName(Frame *f) {
+  auto lock = s->frameIndex.mutex();
+  if(s->frameIndex.valid && s->frameIndex.indexedN+1==frames.N && f==frames.last()) {
+    s->frameIndex.map.emplace((const char*)f->name, f);
+    s->frameIndex.indexedN++;
+  }
+}
+
+void rai::KinematicWorld::invalidateFrameIndex() {
+  if(!s) return; //(s is deleted before the frames)
+  auto lock = s->frameIndex.mutex();
+  s->frameIndex.valid = false;
+}
+
 ///// find shape with specific name
 //rai::Shape* rai::KinematicWorld::getShapeByName(const char* name, bool warnIfNotExist) const {
 //  Frame *f = getFrameByName(name, warnIfNotExist);
@@ -1379,6 +1846,7 @@ StringA rai::KinematicWorld::getFrameNames() const {
 
 /** @brief creates uniques names by prefixing the node-index-number to each name */
 void rai::KinematicWorld::prefixNames(bool clear) {
+  invalidateFrameIndex();
   if(!clear) for(Frame *a: frames) a->name=STRING(a->ID<< a->name);
   else       for(Frame *a: frames) a->name.clear() <<a->ID;
 }
@@ -1405,6 +1873,12 @@ void rai::KinematicWorld::swiftDelete() {
   s->swift = nullptr;
 }
 
+/// return the native collision engine
+BroadphaseInterface& rai::KinematicWorld::broadphase() {
+  if(!s->broadphase) s->broadphase = new BroadphaseInterface(*this, 2.);
+  return *s->broadphase;
+}
+
 /// return a PhysX extension
 PhysXInterface& rai::KinematicWorld::physx() {
   if(!s->physx) {
@@ -1457,12 +1931,20 @@ void rai::KinematicWorld::glGetMasks(int w, int h, bool rgbIndices) {
 }
 
 void rai::KinematicWorld::stepSwift() {
+#ifdef RAI_extern_SWIFT
   swift().step(*this, false);
+#else
+  stepBroadphase();
+#endif
 //  reportProxies();
 //  watch(true);
 //  gl().closeWindow();
 }
 
+void rai::KinematicWorld::stepBroadphase() {
+  broadphase().step(*this);
+}
+
 void rai::KinematicWorld::stepPhysx(double tau) {
   physx().step(tau);
 }
@@ -1669,8 +2151,8 @@ void rai::KinematicWorld::writeURDF(std::ostream &os, const char* robotName) con
         case ST_box:       os <<"      <box size=\"" <<size({0,2}) <<"\" />\n";  break;
         case ST_cylinder:  os <<"      <cylinder length=\"" <<size(2) <<"\" radius=\"" <<size(3) <<"\" />\n";  break;
         case ST_sphere:    os <<"      <sphere radius=\"" <<size(3) <<"\" />\n";  break;
-        case ST_mesh:      os <<"      <mesh filename=\"" <<a->ats.get<rai::FileToken>("mesh").name <<'"';
-          if(a->ats["meshscale"]) os <<" scale=\"" <<a->ats.get<arr>("meshscale") <<'"';
+        case ST_mesh:      os <<"      <mesh filename=\"" <<a->ats().get<rai::FileToken>("mesh").name <<'"';
+          if(a->ats()["meshscale"]) os <<" scale=\"" <<a->ats().get<arr>("meshscale") <<'"';
           os <<" />\n";  break;
         default:           os <<"      <UNKNOWN_" <<a->shape->type() <<" />\n";  break;
       }
@@ -1696,8 +2178,8 @@ void rai::KinematicWorld::writeURDF(std::ostream &os, const char* robotName) con
             case ST_box:       os <<"      <box size=\"" <<size({0,2}) <<"\" />\n";  break;
             case ST_cylinder:  os <<"      <cylinder length=\"" <<size(2) <<"\" radius=\"" <<size(3) <<"\" />\n";  break;
             case ST_sphere:    os <<"      <sphere radius=\"" <<size(3) <<"\" />\n";  break;
-            case ST_mesh:      os <<"      <mesh filename=\"" <<b->ats.get<rai::FileToken>("mesh").name <<'"';
-              if(b->ats["meshscale"]) os <<" scale=\"" <<b->ats.get<arr>("meshscale") <<'"';
+            case ST_mesh:      os <<"      <mesh filename=\"" <<b->ats().get<rai::FileToken>("mesh").name <<'"';
+              if(b->ats()["meshscale"]) os <<" scale=\"" <<b->ats().get<arr>("meshscale") <<'"';
               os <<" />\n";  break;
             default:           os <<"      <UNKNOWN_" <<b->shape->type() <<" />\n";  break;
           }
@@ -1730,7 +2212,7 @@ void rai::KinematicWorld::writeMeshes(const char *pathPrefix) const {
         (f->shape->type()==rai::ST_mesh || f->shape->type()==rai::ST_ssCvx)) {
       rai::String filename = pathPrefix;
       filename <<f->name <<".arr";
-      f->ats.getNew<rai::String>("mesh") = filename;
+      f->getAts().getNew<rai::String>("mesh") = filename;
       if(f->shape->type()==rai::ST_mesh) f->shape->mesh().writeArr(FILE(filename));
       if(f->shape->type()==rai::ST_ssCvx) f->shape->sscCore().writeArr(FILE(filename));
     }
@@ -1849,7 +2331,7 @@ void rai::KinematicWorld::report(std::ostream &os) const {
      <<" #activeShapes=" <<nShapes
      <<" #activeUncertainties=" <<nUc
      <<" #proxies=" <<proxies.N
-     <<" #evals=" <<setJointStateCount
+     <<" #evals=" <<setJointStateCount.load()
      <<endl;
 }
 
@@ -1863,9 +2345,9 @@ void rai::KinematicWorld::init(const Graph& G, bool addInsteadOfClear) {
     
     Frame *b=new Frame(*this);
     if(n->keys.N>1) b->name=n->keys.last();
-    b->ats.copy(n->graph(), false, true);
-    if(n->keys.N>2) b->ats.newNode<bool>({n->keys.last()});
-    b->read(b->ats);
+    b->getAts().copy(n->graph(), false, true);
+    if(n->keys.N>2) b->getAts().newNode<bool>({n->keys.last()});
+    b->read(b->ats());
   }
   
   for(Node *n: G) {
@@ -1878,9 +2360,9 @@ void rai::KinematicWorld::init(const Graph& G, bool addInsteadOfClear) {
     if(!n->parents.N) b = new Frame(*this);
     if(n->parents.N==1) b = new Frame(getFrameByName(n->parents(0)->keys.last()));
     if(n->keys.N && n->keys.last()!="frame") b->name=n->keys.last();
-    b->ats.copy(n->graph(), false, true);
-//    if(n->keys.N>2) b->ats.newNode<bool>({n->keys.last()});
-    b->read(b->ats);
+    b->getAts().copy(n->graph(), false, true);
+//    if(n->keys.N>2) b->getAts().newNode<bool>({n->keys.last()});
+    b->read(b->ats());
   }
   
   NodeL ss = G.getNodes("shape");
@@ -1891,15 +2373,15 @@ void rai::KinematicWorld::init(const Graph& G, bool addInsteadOfClear) {
     
     Frame* f = new Frame(*this);
     if(n->keys.N>1) f->name=n->keys.last();
-    f->ats.copy(n->graph(), false, true);
+    f->getAts().copy(n->graph(), false, true);
     Shape *s = new Shape(*f);
-    s->read(f->ats);
+    s->read(f->ats());
     
     if(n->parents.N==1) {
       Frame *b = listFindByName(frames, n->parents(0)->keys.last());
       CHECK(b, "could not find frame '" <<n->parents(0)->keys.last() <<"'");
       f->linkFrom(b);
-      if(f->ats["rel"]) n->graph().get(f->Q, "rel");
+      if(f->ats()["rel"]) n->graph().get(f->Q, "rel");
     }
   }
   
@@ -1920,13 +2402,13 @@ void rai::KinematicWorld::init(const Graph& G, bool addInsteadOfClear) {
     } else {
       f->name <<'|' <<to->name; //the joint frame is actually the link frame of all child frames
     }
-    f->ats.copy(n->graph(), false, true);
+    f->getAts().copy(n->graph(), false, true);
     
     f->linkFrom(from);
     to->linkFrom(f);
     
     Joint *j=new Joint(*f);
-    j->read(f->ats);
+    j->read(f->ats());
   }
   
   //if the joint is coupled to another:
@@ -1934,7 +2416,7 @@ void rai::KinematicWorld::init(const Graph& G, bool addInsteadOfClear) {
     Joint *j;
     for(Frame *f: frames) if((j=f->joint) && j->mimic) {
         rai::String jointName;
-        bool good = f->ats.get(jointName, "mimic");
+        bool good = f->ats().get(jointName, "mimic");
         if(!good) HALT("something is wrong");
         if(!jointName.N) { j->mimic=NULL; continue; }
         rai::Frame *mimicFrame = getFrameByName(jointName);
@@ -2165,6 +2647,7 @@ void rai::KinematicWorld::kinematicsPenetrations(arr& y, arr& J, bool penetratio
       y(i) = -y_dist.scalar();
       if(!!J) J[i] = -J_dist;
     }
+    i++;
   }
 }
 
@@ -2619,7 +3102,7 @@ bool rai::KinematicWorld::checkConsistency() {
     if(a->joint) CHECK_EQ(&a->joint->frame, a, "");
     if(a->shape) CHECK_EQ(&a->shape->frame, a, "");
     if(a->inertia) CHECK_EQ(&a->inertia->frame, a, "");
-    a->ats.checkConsistency();
+    a->ats().checkConsistency();
 
     CHECK_ZERO(a->X.rot.normalization()-1., 1e-4, "");
     CHECK_ZERO(a->Q.rot.normalization()-1., 1e-4, "");
@@ -13,12 +13,15 @@
 #include <Geo/geo.h>
 #include <Geo/geoms.h>
 #include "featureSymbols.h"
+#include <atomic>
 
 struct OpenGL;
 struct PhysXInterface;
 struct SwiftInterface;
+struct BroadphaseInterface;
 struct OdeInterface;
 struct FeatherstoneInterface;
+struct PairCollisionSeed;
 
 //===========================================================================
 
@@ -66,7 +69,11 @@ struct KinematicWorld : GLDrawer {
   
   ProxyA proxies; ///< list of current proximities between bodies
   
-  static uint setJointStateCount;
+  static std::atomic<uint> setJointStateCount; ///< global counter; atomic as configurations may be set in parallel
+  bool useJacobianCache=false; ///< memoize jacobianPos and axesMatrix per (frame, point) until the next state change (or a change of the frame's X)
+  bool useIncrementalFK=false; ///< setJointState only recomputes the subtrees below joints whose q changed (see calc_fwdPropagateChanged); off by default, as writes to q, X or Q that bypass the KinematicWorld methods then require a call of invalidateJacobianCache() before the next setJointState
+  bool useCollisionSeeds=true; ///< PairCollision queries (TM_PairCollision, Proxy::calc_coll) warm start GJK from the last query of the same frame pair
+  uint activeSetVersion=0; ///< identifies the structure of the active sets: calc_activeSets draws a new one, copies keep it
   
   //global options
   bool orsDrawJoints=false, orsDrawShapes=true, orsDrawBodies=true, orsDrawProxies=true, orsDrawMarkers=true, orsDrawColors=true, orsDrawIndexColors=false;
@@ -97,6 +104,10 @@ struct KinematicWorld : GLDrawer {
   Frame *operator[](const char* name) { return getFrameByName(name, true); }
   Frame *operator()(int i) { return frames(i); }
   Frame *getFrameByName(const char* name, bool warnIfNotExist=true) const;
+  FrameL getFramesByNames(const StringA& names, bool warnIfNotExist=true) const;
+  uintA getFrameIDs(const StringA& names) const; ///< HALTs if a name doesn't exist
+  void indexFrameName(Frame *f); ///< sort of private: adds a newly created & named frame to the name index
+  void invalidateFrameIndex(); ///< sort of private: called when frames are deleted or renamed in bulk
 //  Link  *getLinkByBodies(const Frame* from, const Frame* to) const;
   Joint *getJointByBodies(const Frame* from, const Frame* to) const;
   Joint *getJointByBodyNames(const char* from, const char* to) const;
@@ -132,6 +143,7 @@ struct KinematicWorld : GLDrawer {
   void calc_Q_from_q(); ///< from the set (q,qdot) compute the joint's Q transformations
   void calc_q_from_Q();  ///< updates (q,qdot) based on the joint's Q transformations
   void calc_fwdPropagateFrames();    ///< elementary forward kinematics; also computes all Shape frames
+  void calc_fwdPropagateChanged();   ///< calc_Q_from_q and calc_fwdPropagateFrames, but only for the joints setJointState marked as changed (and their subtrees)
   arr calc_fwdPropagateVelocities();    ///< elementary forward kinematics; also computes all Shape frames
   void calc_Q_from_BodyFrames();    ///< fill in the joint transformations assuming that body poses are known (makes sense when reading files)
   
@@ -163,6 +175,8 @@ struct KinematicWorld : GLDrawer {
 
   /// @name features
   void evalFeature(arr& y, arr& J, FeatureSymbol fs, const StringA &symbols) const;
+  void evalFeatureBatch(arr& Y, arr& J, const arr& Qs, const rai::Array<FeatureSymbol>& fs, const rai::Array<StringA>& symbols, uint threads=1) const; ///< Y(r,:) are the stacked features at joint state Qs[r] (J: Qs.d0 x Y.d1 x n); evaluated on copies of this world, which remains unchanged
+  void kinematicsPosBatch(arr& Y, arr& J, const arr& Qs, const FrameL& frames, uint threads=1) const; ///< Y(r,i,:) is the position of frames(i) at joint state Qs[r] (J: Qs.d0 x 3*frames.N x n)
 
   /// @name kinematics (low level)
   void kinematicsPos(arr& y, arr& J, Frame *a, const Vector& rel=NoVector) const;  //TODO: make vector& not vector*
@@ -170,9 +184,15 @@ struct KinematicWorld : GLDrawer {
   void kinematicsQuat(arr& y, arr& J, Frame *a) const;
   void hessianPos(arr& H, Frame *a, Vector *rel=0) const;
   void jacobianPos(arr& J, Frame *a, const rai::Vector& pos_world) const; //usually called internally with kinematicsPos
+  void jacobianPos(arr& J, uintA& cols, Frame *a, const rai::Vector& pos_world) const; ///< compact: J(:,c) is the column cols(c) of the dense jacobianPos (columns can repeat with mimic joints)
   void kinematicsTau(double& tau, arr& J) const;
   void jacobianTime(arr& J, Frame*a) const;
   void axesMatrix(arr& J, Frame *a) const; //usually called internally with kinematicsVec or Quat
+  void invalidateJacobianCache(); ///< called whenever q or the frame poses change: jacobianPos and axesMatrix are memoized until then
+  void getJacobianCacheCounts(uint& hits, uint& misses) const;
+  bool getCollisionSeed(PairCollisionSeed& seed, uint a, uint b) const; ///< the GJK state of the last PairCollision query between frames a and b
+  void putCollisionSeed(const PairCollisionSeed& seed, uint a, uint b, uint iterations) const;
+  void getCollisionIterationCounts(uint& queries, uint& iterations) const; ///< GJK iterations of all queries: iterations/queries is the average
   void kinematicsRelPos(arr& y, arr& J, Frame *a, const Vector& vec1, Frame *b, const Vector& vec2) const;
   void kinematicsRelVec(arr& y, arr& J, Frame *a, const Vector& vec1, Frame *b) const;
   void kinematicsRelRot(arr& y, arr& J, Frame *a, Frame *b) const;
@@ -227,6 +247,7 @@ struct KinematicWorld : GLDrawer {
   OpenGL& gl(const char* window_title=NULL);
   SwiftInterface& swift();
   void swiftDelete();
+  BroadphaseInterface& broadphase(); ///< a native collision engine, see kin_broadphase.h
   PhysXInterface& physx();
   OdeInterface& ode();
   FeatherstoneInterface& fs();
@@ -234,6 +255,7 @@ struct KinematicWorld : GLDrawer {
   void glAnimate();
   void glGetMasks(int w=-1, int h=-1, bool rgbIndices=true);
   void stepSwift();
+  void stepBroadphase();
   void stepPhysx(double tau);
   void stepOde(double tau);
   void stepDynamics(const arr& u_control, double tau, double dynamicNoise = 0.0, bool gravity = true);
@@ -263,6 +285,25 @@ struct KinematicWorld : GLDrawer {
   friend struct KinematicSwitch;
 };
 
+//===========================================================================
+
+/// the state (not the structure) of a KinematicWorld: save and restore copy into preallocated memory, so that
+/// many states (e.g. of a search tree) can be stored and restored without copying worlds
+struct WorldState {
+  uint activeSetVersion=0;         ///< the world's activeSetVersion when saved; restoring into another structure recreates the contacts and active sets
+  arr q, qdot;
+  arr X, Q;                        ///< (frames x 7) absolute and relative poses of all frames
+  uintA contactFrames;             ///< (contacts x 2) the frame IDs of each contact (their positions and forces are part of q)
+  boolA contactSoft;
+  
+  void save(const KinematicWorld& K);
+  void restore(KinematicWorld& K) const;
+  
+  void write(std::ostream& os) const;
+  void read(std::istream& is);
+};
+stdPipes(WorldState)
+
 } //namespace rai
 
 stdPipes(rai::KinematicWorld)
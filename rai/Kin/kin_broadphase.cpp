@@ -0,0 +1,179 @@
+/*  ------------------------------------------------------------------
+    Copyright (c) 2017 Marc Toussaint
+    email: marc.toussaint@informatik.uni-stuttgart.de
+
+    This code is distributed under the MIT License.
+    Please see <root-path>/LICENSE for details.
+    --------------------------------------------------------------  */
+
+#include "kin_broadphase.h"
+#include "proxy.h"
+#include "frame.h"
+
+static uint64_t pairKey(uint a, uint b) {
+  if(a>b) std::swap(a, b);
+  return (uint64_t(a)<<32) | b;
+}
+
+BroadphaseInterface::BroadphaseInterface(const rai::KinematicWorld& world, double _cutoff)
+  : cutoff(_cutoff) {
+  INDEXframe2object.resize(world.frames.N);
+  for(int& i:INDEXframe2object) i=-1;
+  rai::Shape *s;
+  for(rai::Frame *f: world.frames) if((s=f->shape) && s->cont) {
+      if(s->type()==rai::ST_marker || s->type()==rai::ST_pointCloud) continue; //no collisions
+      if(!s->mesh().V.d0) {
+        s->getGeom().createMeshes();
+        CHECK(s->mesh().V.d0, "the mesh must have been created earlier -- has size zero!");
+      }
+      INDEXframe2object(f->ID) = objects.N;
+      objects.append(f->ID);
+    }
+
+  //the local boxes of the geometry that the narrowphase (Proxy::calc_coll) uses: the core plus radius, or the mesh
+  localBox.resize(objects.N, 2, 3);
+  for(uint k=0; k<objects.N; k++) {
+    rai::Shape *s = world.frames(objects(k))->shape;
+    double r = s->size().N>3 ? s->size(3) : 0.;
+    rai::Mesh *m = &s->sscCore();  if(!m->V.N) { m = &s->mesh(); r=0.; }
+    for(uint i=0; i<3; i++) {
+      double lo=m->V(0, i), up=lo;
+      for(uint v=1; v<m->V.d0; v++) { double x=m->V(v, i); if(x<lo) lo=x; if(x>up) up=x; }
+      localBox(k, 0, i) = lo-r;
+      localBox(k, 1, i) = up+r;
+    }
+  }
+  box.resize(objects.N, 2, 3).setZero();
+  order.setStraightPerm(objects.N);
+  objectActive.resize(objects.N);
+  for(uint k=0; k<objects.N; k++) objectActive(k)=true;
+
+  initActivations(world);
+}
+
+void BroadphaseInterface::calcBoxes(const rai::KinematicWorld& world) {
+  double m=.5*cutoff;
+  double R[9];
+  for(uint k=0; k<objects.N; k++) {
+    const rai::Transformation& X = world.frames.elem(objects.p[k])->X;
+    X.rot.getMatrix(R);
+    const double *lo=&localBox(k, 0, 0), *up=&localBox(k, 1, 0);
+    rai::Vector c(.5*(lo[0]+up[0]), .5*(lo[1]+up[1]), .5*(lo[2]+up[2]));
+    double h[3] = {.5*(up[0]-lo[0]), .5*(up[1]-lo[1]), .5*(up[2]-lo[2])};
+    c = X*c;
+    double *b=&box(k, 0, 0);
+    for(uint i=0; i<3; i++) {
+      double hi = fabs(R[3*i])*h[0] + fabs(R[3*i+1])*h[1] + fabs(R[3*i+2])*h[2] + m;
+      b[i] = c.p()[i]-hi;
+      b[3+i] = c.p()[i]+hi;
+    }
+  }
+}
+
+void BroadphaseInterface::sweep() {
+  //insertion sort of the previous order: about linear when the boxes moved little
+  for(uint i=1; i<order.N; i++) {
+    uint k=order.p[i];
+    double x=box.p[6*k];
+    uint j=i;
+    for(; j>0 && box.p[6*order.p[j-1]]>x; j--) order.p[j]=order.p[j-1];
+    order.p[j]=k;
+  }
+
+  //sweep along x; test y and z of all boxes whose x-intervals overlap
+  pairs.clear();
+  for(uint i=0; i<order.N; i++) {
+    uint a=order.p[i];
+    if(!objectActive.p[a]) continue;
+    const double *A=box.p+6*a;
+    for(uint j=i+1; j<order.N; j++) {
+      uint b=order.p[j];
+      const double *B=box.p+6*b;
+      if(B[0]>A[3]) break;
+      if(!objectActive.p[b]) continue;
+      if(B[1]>A[4] || A[1]>B[4] || B[2]>A[5] || A[2]>B[5]) continue;
+      if(deactivatedPairs.size() && deactivatedPairs.count(pairKey(objects.p[a], objects.p[b]))) continue;
+      if(a<b) pairs.append({a, b}); else pairs.append({b, a});
+    }
+  }
+  pairs.reshape(pairs.N/2, 2);
+
+  //a canonical order, independent of the sweep order
+  std::sort((std::pair<uint, uint>*)pairs.p, (std::pair<uint, uint>*)pairs.p+pairs.d0);
+}
+
+void BroadphaseInterface::step(rai::KinematicWorld& world) {
+  CHECK_EQ(INDEXframe2object.N, world.frames.N, "the number of frames has changed -- create a new broadphase");
+  calcBoxes(world);
+  sweep();
+
+  //narrowphase
+  for(rai::Proxy& p:world.proxies) p.del_coll();
+  world.proxies.resize(pairs.d0);
+  uint n=0;
+  for(uint i=0; i<pairs.d0; i++) {
+    rai::Proxy& p = world.proxies(n);
+    p.a = world.frames(objects(pairs(i, 0)));
+    p.b = world.frames(objects(pairs(i, 1)));
+    p.calc_coll(world);
+    if(p.d<cutoff) n++;
+  }
+  world.proxies.resizeCopy(n);
+}
+
+void BroadphaseInterface::activate(rai::Frame *s) {
+  if(INDEXframe2object(s->ID)==-1) return;
+  objectActive(INDEXframe2object(s->ID)) = true;
+}
+
+void BroadphaseInterface::deactivate(rai::Frame *s) {
+  if(INDEXframe2object(s->ID)==-1) return;
+  objectActive(INDEXframe2object(s->ID)) = false;
+}
+
+void BroadphaseInterface::activate(rai::Frame *s1, rai::Frame *s2) {
+  deactivatedPairs.erase(pairKey(s1->ID, s2->ID));
+}
+
+void BroadphaseInterface::deactivate(rai::Frame *s1, rai::Frame *s2) {
+  if(INDEXframe2object(s1->ID)==-1 || INDEXframe2object(s2->ID)==-1) return;
+  deactivatedPairs.insert(pairKey(s1->ID, s2->ID));
+}
+
+void BroadphaseInterface::deactivate(const FrameL& shapes1, const FrameL& shapes2) {
+  for(rai::Frame *s1: shapes1) for(rai::Frame *s2: shapes2) if(s1->ID > s2->ID) deactivate(s1, s2);
+}
+
+void BroadphaseInterface::deactivate(const FrameL& shapes) {
+  deactivate(shapes, shapes);
+}
+
+void BroadphaseInterface::initActivations(const rai::KinematicWorld& world) {
+  //shapes within a link
+  for(uint k:objects) {
+    FrameL F;
+    world.frames(k)->getUpwardLink()->getRigidSubFrames(F);
+    for(uint i=F.N; i--;) if(!F(i)->shape || !F(i)->shape->cont) F.remove(i);
+    deactivate(F);
+  }
+
+  //deactivate upward, depending on cont parameter (-1 indicates deactivate with parent)
+  for(uint k:objects) {
+    rai::Frame *f = world.frames(k);
+    if(f->shape->cont>=0) continue;
+    FrameL F, P;
+    rai::Frame* p = f->getUpwardLink();
+    p->getRigidSubFrames(F);
+    for(uint i=F.N; i--;) if(!F(i)->shape || !F(i)->shape->cont) F.remove(i);
+
+    for(char i=0; i<-f->shape->cont; i++) {
+      p = p->parent;
+      if(!p) break;
+      p = p->getUpwardLink();
+      p->getRigidSubFrames(P);
+      for(uint i=P.N; i--;) if(!P(i)->shape || !P(i)->shape->cont) P.remove(i);
+
+      if(F.N && P.N) deactivate(F, P);
+    }
+  }
+}
@@ -0,0 +1,48 @@
+/*  ------------------------------------------------------------------
+    Copyright (c) 2017 Marc Toussaint
+    email: marc.toussaint@informatik.uni-stuttgart.de
+
+    This code is distributed under the MIT License.
+    Please see <root-path>/LICENSE for details.
+    --------------------------------------------------------------  */
+
+#pragma once
+
+#include "kin.h"
+#include <unordered_set>
+
+//===========================================================================
+
+/** A native collision engine (needs no external library): a sweep-and-prune broadphase over the world-aligned boxes
+ *  of all collision shapes, and PairCollision as narrowphase. The sweep order is kept from step to step, so that it
+ *  is re-sorted in about linear time when the configuration changed only little (temporal coherence).
+ *  step() fills the world's proxies like SwiftInterface::step does: one proxy for each active pair of shapes that are
+ *  closer than the cutoff. Each world can own its own instance (see KinematicWorld::broadphase). */
+struct BroadphaseInterface {
+  double cutoff;
+  uintA objects;           ///< the frame IDs of the collision shapes
+  intA INDEXframe2object;  ///< -1 for frames without collision shape
+  arr localBox;            ///< (objects x 2 x 3) lower and upper corners of the shapes in their frames (including the radius)
+  arr box;                 ///< (objects x 2 x 3) the world-aligned boxes of the last step, enlarged by cutoff/2
+  uintA order;             ///< the objects, sorted by the lower x-coordinate of their box in the last step
+  boolA objectActive;
+  std::unordered_set<uint64_t> deactivatedPairs; ///< pairs of frame IDs (the lower ID in the upper bits)
+  uintA pairs;             ///< (candidates x 2) the overlapping boxes of the last step (object indices, sorted)
+
+  BroadphaseInterface(const rai::KinematicWorld& world, double _cutoff=.2);
+
+  void setCutoff(double _cutoff) { cutoff=_cutoff; }
+
+  void step(rai::KinematicWorld& world);
+  void calcBoxes(const rai::KinematicWorld& world);
+  void sweep();
+
+  void activate(rai::Frame *s);
+  void deactivate(rai::Frame *s);
+  void activate(rai::Frame *s1, rai::Frame *s2);
+  void deactivate(rai::Frame *s1, rai::Frame *s2);
+  void deactivate(const FrameL& shapes1, const FrameL& shapes2);
+  void deactivate(const FrameL& shapes);
+
+  void initActivations(const rai::KinematicWorld& world); ///< the same rules as SwiftInterface::initActivations
+};
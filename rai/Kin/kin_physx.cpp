@@ -299,16 +299,16 @@ void sPhysXInterface::addJoint(rai::Joint *jj) {
       PxD6Joint *desc = PxD6JointCreate(*mPhysics, actors(from->ID), A, actors(jj->frame.ID), B.getInverse());
       CHECK(desc, "PhysX joint creation failed.");
       
-      if(jj->frame.ats.find<arr>("drive")) {
-        arr drive_values = jj->frame.ats.get<arr>("drive");
+      if(jj->frame.ats().find<arr>("drive")) {
+        arr drive_values = jj->frame.ats().get<arr>("drive");
         PxD6JointDrive drive(drive_values(0), drive_values(1), PX_MAX_F32, true);
         desc->setDrive(PxD6Drive::eTWIST, drive);
       }
       
-      if(jj->frame.ats.find<arr>("limit")) {
+      if(jj->frame.ats().find<arr>("limit")) {
         desc->setMotion(PxD6Axis::eTWIST, PxD6Motion::eLIMITED);
         
-        arr limits = jj->frame.ats.get<arr>("limit");
+        arr limits = jj->frame.ats().get<arr>("limit");
         PxJointAngularLimitPair limit(limits(0), limits(1), 0.1f);
         limit.restitution = limits(2);
         //limit.spring = limits(3);
@@ -319,8 +319,8 @@ void sPhysXInterface::addJoint(rai::Joint *jj) {
         desc->setMotion(PxD6Axis::eTWIST, PxD6Motion::eFREE);
       }
       
-      if(jj->frame.ats.find<arr>("drive")) {
-        arr drive_values = jj->frame.ats.get<arr>("drive");
+      if(jj->frame.ats().find<arr>("drive")) {
+        arr drive_values = jj->frame.ats().get<arr>("drive");
         PxD6JointDrive drive(drive_values(0), drive_values(1), PX_MAX_F32, false);
         desc->setDrive(PxD6Drive::eTWIST, drive);
         //desc->setDriveVelocity(PxVec3(0, 0, 0), PxVec3(5e-1, 0, 0));
@@ -355,16 +355,16 @@ void sPhysXInterface::addJoint(rai::Joint *jj) {
       PxD6Joint *desc = PxD6JointCreate(*mPhysics, actors(jj->from()->ID), A, actors(jj->frame.ID), B.getInverse());
       CHECK(desc, "PhysX joint creation failed.");
       
-      if(jj->frame.ats.find<arr>("drive")) {
-        arr drive_values = jj->frame.ats.get<arr>("drive");
+      if(jj->frame.ats().find<arr>("drive")) {
+        arr drive_values = jj->frame.ats().get<arr>("drive");
         PxD6JointDrive drive(drive_values(0), drive_values(1), PX_MAX_F32, true);
         desc->setDrive(PxD6Drive::eX, drive);
       }
       
-      if(jj->frame.ats.find<arr>("limit")) {
+      if(jj->frame.ats().find<arr>("limit")) {
         desc->setMotion(PxD6Axis::eX, PxD6Motion::eLIMITED);
         
-        arr limits = jj->frame.ats.get<arr>("limit");
+        arr limits = jj->frame.ats().get<arr>("limit");
         PxJointLinearLimit limit(mPhysics->getTolerancesScale(), limits(0), 0.1f);
         limit.restitution = limits(2);
         //if(limits(3)>0) {
@@ -545,6 +545,7 @@ void PhysXInterface::pullFromPhysx(rai::KinematicWorld *K, arr& vels) {
   }
 //  K->calc_Q_from_BodyFrames();
 //  K->calc_q_from_Q();
+  K->invalidateJacobianCache(); //X and Q were written directly
 }
 
 void PhysXInterface::pushToPhysx(rai::KinematicWorld *K, rai::KinematicWorld *Kt_1, rai::KinematicWorld *Kt_2, double tau, bool onlyKinematic) {
@@ -61,7 +61,7 @@ SwiftInterface::SwiftInterface(const rai::KinematicWorld& world, double _cutoff)
         case rai::ST_none: HALT("shapes should have a type - somehow wrong initialization..."); break;
         case rai::ST_mesh: {
           //check if there is a specific swiftfile!
-          rai::FileToken *file = s->frame.ats.find<rai::FileToken>("swiftfile");
+          rai::FileToken *file = s->frame.ats().find<rai::FileToken>("swiftfile");
           if(false && file) {
             r=scene->Add_General_Object(file->name, INDEXshape2swift(f->ID), false);
             CHECK_GE(INDEXshape2swift(f->ID), 0, "no object generated from swiftfile");
@@ -108,9 +108,16 @@ SwiftInterface::SwiftInterface(const rai::KinematicWorld& world, double _cutoff)
   initActivations(world, 4);
   
   pushToSwift(world);
+  logActivations=true;
 //  cout <<"...done" <<endl;
 }
 
+SwiftInterface::SwiftInterface(const rai::KinematicWorld& world, const SwiftInterface& reference)
+  : SwiftInterface(world, reference.cutoff) {
+  CHECK(INDEXshape2swift==reference.INDEXshape2swift, "the world's collision shapes differ from the reference");
+  syncActivations(world, reference);
+}
+
 void SwiftInterface::reinitShape(const rai::Frame *f) {
   HALT("why?");
   int sw = INDEXshape2swift(f->ID);
@@ -144,9 +151,9 @@ void SwiftInterface::initActivations(const rai::KinematicWorld& world, uint pare
   
   for(rai::Frame *f: world.frames) if(f->shape) {
       if(!f->shape->cont) {
-        if(INDEXshape2swift(f->ID)!=-1) scene->Deactivate(INDEXshape2swift(f->ID));
+        deactivate(f);
       } else {
-        if(INDEXshape2swift(f->ID)!=-1) scene->Activate(INDEXshape2swift(f->ID));
+        activate(f);
 //        cout <<"activating " <<f->name <<endl;
       }
     }
@@ -160,7 +167,7 @@ void SwiftInterface::initActivations(const rai::KinematicWorld& world, uint pare
 #if 0
   //deactivate along trees...
   for(rai::Frame *b: world.frames) if(b->shape && b->shape->cont){
-    if(!b->ats["robot"]) continue;
+    if(!b->ats()["robot"]) continue;
     FrameL group, children;
     group.append(b->getUpwardLink());
     //all rigid links as well
@@ -203,6 +210,7 @@ void SwiftInterface::initActivations(const rai::KinematicWorld& world, uint pare
 void SwiftInterface::deactivate(rai::Frame *s1, rai::Frame *s2) {
   if(INDEXshape2swift(s1->ID)==-1 || INDEXshape2swift(s2->ID)==-1) return;
   //cout <<"deactivating shape pair " <<s1->name <<'-' <<s2->name <<endl;
+  if(logActivations) activationLog.append({0, (int)s1->ID, (int)s2->ID});
   scene->Deactivate(INDEXshape2swift(s1->ID), INDEXshape2swift(s2->ID));
 }
 
@@ -223,16 +231,19 @@ void SwiftInterface::deactivate(const FrameL& shapes) {
 void SwiftInterface::activate(rai::Frame *s1, rai::Frame *s2) {
   if(INDEXshape2swift(s1->ID)==-1 || INDEXshape2swift(s2->ID)==-1) return;
   //cout <<"deactivating shape pair " <<s1->name <<'-' <<s2->name <<endl;
+  if(logActivations) activationLog.append({1, (int)s1->ID, (int)s2->ID});
   scene->Activate(INDEXshape2swift(s1->ID), INDEXshape2swift(s2->ID));
 }
 
 void SwiftInterface::activate(rai::Frame *s) {
   if(INDEXshape2swift(s->ID)==-1) return;
+  if(logActivations) activationLog.append({1, (int)s->ID, -1});
   scene->Activate(INDEXshape2swift(s->ID));
 }
 
 void SwiftInterface::deactivate(rai::Frame *s) {
   if(INDEXshape2swift(s->ID)==-1) return;
+  if(logActivations) activationLog.append({0, (int)s->ID, -1});
   scene->Deactivate(INDEXshape2swift(s->ID));
 }
 
@@ -386,6 +397,19 @@ void SwiftInterface::swiftQueryExactDistance() {
   }
 }
 
+void SwiftInterface::syncActivations(const rai::KinematicWorld& world, const SwiftInterface& reference) {
+  cutoff = reference.cutoff;
+  //each replayed change is logged here as well, so the logs stay in sync
+  CHECK_LE(activationLog.N, reference.activationLog.N, "this is not a copy of the reference");
+  for(uint i=activationLog.N; i<reference.activationLog.N; i+=3) {
+    const int *a = reference.activationLog.p+i;
+    rai::Frame *f1 = world.frames(a[1]);
+    rai::Frame *f2 = a[2]>=0 ? world.frames(a[2]) : NULL;
+    if(a[0]) { if(f2) activate(f1, f2); else activate(f1); }
+    else     { if(f2) deactivate(f1, f2); else deactivate(f1); }
+  }
+}
+
 uint SwiftInterface::countObjects() {
   uint n=0;
   for(int& i : INDEXshape2swift) if(i>=0) n++;
@@ -23,8 +23,11 @@ struct SwiftInterface {
   SWIFT_Scene *scene;
   intA INDEXswift2frame, INDEXshape2swift;
   double cutoff;
+  intA activationLog; ///< (de)activations done after construction, as triples (activate?, frameID1, frameID2 or -1)
+  bool logActivations=false;
   
   SwiftInterface(const rai::KinematicWorld& world, double _cutoff=.2);
+  SwiftInterface(const rai::KinematicWorld& world, const SwiftInterface& reference); ///< an independent scene with the same objects, cutoff and activations
   ~SwiftInterface();
   
   void setCutoff(double _cutoff) { cutoff=_cutoff; }
@@ -43,6 +46,7 @@ struct SwiftInterface {
   void deactivate(const FrameL& shapes);
   
   void initActivations(const rai::KinematicWorld& world, uint parentLevelsToDeactivate=1);
+  void syncActivations(const rai::KinematicWorld& world, const SwiftInterface& reference); ///< replay the reference's activation changes not yet applied here
   void swiftQueryExactDistance();
   uint countObjects();
 };
@@ -49,8 +49,11 @@ void rai::Proxy::calc_coll(const KinematicWorld& K) {
   rai::Mesh *m1 = &s1->sscCore();  if(!m1->V.N) { m1 = &s1->mesh(); r1=0.; }
   rai::Mesh *m2 = &s2->sscCore();  if(!m2->V.N) { m2 = &s2->mesh(); r2=0.; }
 
+  PairCollisionSeed seed;
+  if(K.useCollisionSeeds) K.getCollisionSeed(seed, a->ID, b->ID);
   if(coll) coll.reset();
-  coll = std::make_shared<PairCollision>(*m1, *m2, s1->frame.X, s2->frame.X, r1, r2);
+  coll = std::make_shared<PairCollision>(*m1, *m2, s1->frame.X, s2->frame.X, r1, r2, &seed);
+  K.putCollisionSeed(seed, a->ID, b->ID, coll->iterations);
   
   d = coll->distance-coll->rad1-coll->rad2;
   posA = coll->p1;
@@ -68,20 +68,20 @@ struct DisplayThread : MiniThread {
 };
 
 void initFolStateFromKin(FOL_World& L, const rai::KinematicWorld& K) {
-  for(rai::Frame *a:K.frames) if(a->ats["logical"]) {
-    const Graph& G = a->ats["logical"]->graph();
+  for(rai::Frame *a:K.frames) if(a->ats()["logical"]) {
+    const Graph& G = a->ats()["logical"]->graph();
     for(Node *n:G) L.addFact({n->keys.last(), a->name});
   }
-  for(rai::Frame *a:K.frames) if(a->shape && a->ats["logical"]) {
+  for(rai::Frame *a:K.frames) if(a->shape && a->ats()["logical"]) {
     rai::Frame *p = a->getUpwardLink();
     if(!p) continue;
     FrameL F;
     p->getRigidSubFrames(F);
-    for(rai::Frame *b:F) if(b!=a && b->shape && b->ats["logical"]) {
+    for(rai::Frame *b:F) if(b!=a && b->shape && b->ats()["logical"]) {
       L.addFact({"partOf", a->name, b->name});
     }
   }
-  for(rai::Frame *a:K.frames) if(a->shape && a->ats["logical"]) {
+  for(rai::Frame *a:K.frames) if(a->shape && a->ats()["logical"]) {
     rai::Frame *p = a;
     while(p && !p->joint) p=p->parent;
     if(!p) continue;
@@ -92,7 +92,7 @@ void initFolStateFromKin(FOL_World& L, const rai::KinematicWorld& K) {
       if(p->joint) break;
       p=p->parent;
     }
-    for(rai::Frame *b:F) if(b!=a && b->shape && b->ats["logical"]) {
+    for(rai::Frame *b:F) if(b!=a && b->shape && b->ats()["logical"]) {
       L.addFact({"on", a->name, b->name});
     }
   }
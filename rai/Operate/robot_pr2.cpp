@@ -52,7 +52,7 @@ Robot_PR2_PathThread::Robot_PR2_PathThread(const rai::KinematicWorld& _K)
     Kp_base = zeros(q0.N);
     Kd_base = zeros(q0.N);
     for(rai::Joint *j: K.fwdActiveJoints) if(j->qDim()>0) {
-        arr *gains = j->frame.ats.find<arr>("gains");
+        arr *gains = j->frame.ats().find<arr>("gains");
         if(gains) {
           for(uint i=0; i<j->qDim(); i++) {
             Kp_base(j->qIndex+i)=gains->elem(0);
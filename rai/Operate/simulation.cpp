@@ -90,6 +90,20 @@ void Simulation::setJointState(const StringA &joints, const arr &q_ref){
   K.setJointState(q_ref, joints);
 }
 
+rai::WorldState Simulation::getState(){
+  auto lock = self->threadLock();
+
+  rai::WorldState state;
+  state.save(K);
+  return state;
+}
+
+void Simulation::restoreState(const rai::WorldState& state){
+  auto lock = self->threadLock();
+
+  state.restore(K);
+}
+
 void Simulation::setJointStateSafe(arr q_ref, StringA &jointsInLimit, StringA &collisionPairs){
   auto lock = self->threadLock();
 
@@ -255,7 +269,7 @@ arr Simulation::getObjectPoses(const StringA &objects){
     for(const rai::String& s:objects) objs.append(K[s]);
   }else{//non specified... go through the list and pick 'percets'
     for(rai::Frame *a:K.frames){
-      if(a->ats["percept"]) objs.append(a);
+      if(a->ats()["percept"]) objs.append(a);
     }
   }
 
@@ -275,7 +289,7 @@ StringA Simulation::getObjectNames(){
 
   StringA objs;
   for(rai::Frame *a:K.frames){
-    if(a->ats["percept"]) objs.append(a->name);
+    if(a->ats()["percept"]) objs.append(a->name);
   }
   return objs;
 }
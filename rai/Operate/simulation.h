@@ -50,8 +50,8 @@ struct Simulation : GLDrawer{
   void setJointStateSafe(arr q_ref, StringA& jointsInLimit, StringA& collisionPairs);
 
   //-- store and restore simulator state
-  rai::KinematicWorld getState();
-  void restoreState(rai::KinematicWorld& K);
+  rai::WorldState getState();
+  void restoreState(const rai::WorldState& state);
 
   //-- the narrow action interface
   StringA getRobotJoints(); //info on the joints; the plan needs to have same dimensionality
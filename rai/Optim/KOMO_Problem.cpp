@@ -77,33 +77,54 @@ void KOMO_GraphProblem::phi(arr& phi, arrA& J, arrA& H, const arr& x, arr& lambd
 }
 
 Conv_KOMO_ConstrainedProblem::Conv_KOMO_ConstrainedProblem(KOMO_Problem& P) : KOMO(P) {
+  updateStructure();
+}
+
+void Conv_KOMO_ConstrainedProblem::updateStructure() {
   KOMO.getStructure(variableDimensions, featureTimes, featureTypes);
   varDimIntegral = integral(variableDimensions);
+  
+  //-- the row-shifted sparsity pattern of J: the i-th feature depends on x_{t-k:t} only
+  uint k=KOMO.get_k();
+  J_width = (k+1)*max(variableDimensions);
+  J_rowShift.resize(featureTimes.N);
+  for(uint i=0; i<featureTimes.N; i++) {
+    uint t=featureTimes(i);
+    if(t<=k) J_rowShift(i) = 0;
+    else J_rowShift(i) = varDimIntegral(t-k-1);
+  }
 }
 
 void Conv_KOMO_ConstrainedProblem::phi(arr& phi, arr& J, arr& H, ObjectiveTypeA& featureTypes, const arr& x, arr& lambda) {
-  KOMO.phi(phi, (!!J?J_KOMO:NoArrA), (!!H?H_KOMO:NoArrA), featureTimes, featureTypes, x, lambda);
+  if(x.N!=varDimIntegral.last()) updateStructure(); //the variables changed since the last call
   
-  //-- construct a row-shifed J from the array of featureJs
   if(!!J) {
-    uint k=KOMO.get_k();
-    uint dim_xmax = max(variableDimensions);
-    RowShifted *Jaux = makeRowShifted(J, phi.N, (k+1)*dim_xmax, x.N);
-    J.setZero();
-    
-    //loop over features
-    for(uint i=0; i<phi.N; i++) {
-      arr& Ji = J_KOMO(i);
-      CHECK_LE(Ji.N, J.d1,"");
-      //        J({i, 0, J_KOMO(i}).N-1) = J_KOMO(i);
-      memmove(&J(i,0), Ji.p, Ji.sizeT*Ji.N);
-      uint t=featureTimes(i);
-      if(t<=k) Jaux->rowShift(i) = 0;
-      else Jaux->rowShift(i) =  varDimIntegral(t-k-1);
+    //-- preferably, the problem writes directly into the row-shifted J (reusing its memory)
+    RowShifted *Jaux = makeRowShifted(J, J_rowShift.N, J_width, x.N);
+    Jaux->rowShift = J_rowShift;
+    if(KOMO.phiRowShifted(phi, J, (!!H?H_KOMO:NoArrA), featureTimes, featureTypes, x, lambda)) {
+      CHECK_EQ(phi.N, J.d0, "");
+    } else { //(also when the problem's structure changed and doesn't fit J anymore)
+      KOMO.phi(phi, J_KOMO, (!!H?H_KOMO:NoArrA), featureTimes, featureTypes, x, lambda);
+      if(phi.N!=J_rowShift.N) {
+        updateStructure();
+        Jaux = makeRowShifted(J, J_rowShift.N, J_width, x.N);
+        Jaux->rowShift = J_rowShift;
+      }
+      CHECK_EQ(phi.N, J.d0, "the problem's structure (number of features) changed without notice");
+      
+      //-- construct a row-shifed J from the array of featureJs
+      for(uint i=0; i<phi.N; i++) {
+        arr& Ji = J_KOMO(i);
+        CHECK_LE(Ji.N, J.d1,"");
+        memmove(&J(i,0), Ji.p, Ji.sizeT*Ji.N);
+      }
     }
     
     Jaux->reshift();
     Jaux->computeColPatches(true);
+  } else {
+    KOMO.phi(phi, NoArrA, (!!H?H_KOMO:NoArrA), featureTimes, featureTypes, x, lambda);
   }
   
   if(!!H) {
@@ -16,6 +16,10 @@ struct KOMO_Problem {
   virtual uint get_k() = 0;
   virtual void getStructure(uintA& variableDimensions, uintA& featureTimes, ObjectiveTypeA& featureTypes)=0;
   virtual void phi(arr& phi, arrA& J, arrA& H, uintA& featureTimes, ObjectiveTypeA& tt, const arr& x, arr& lambda) = 0;
+  /// optional: as phi, but each feature's Jacobian is written directly into row i of J, which is preallocated as RowShifted
+  /// (d0=#features; row i starts at column x_{t-k} of its feature time t); returns false if not implemented, or if J doesn't
+  /// fit the current structure (then phi is called and the caller queries the structure again)
+  virtual bool phiRowShifted(arr& phi, arr& J, arrA& H, uintA& featureTimes, ObjectiveTypeA& tt, const arr& x, arr& lambda) { return false; }
   
   bool checkStructure(const arr& x);                 ///< check if Jacobians and Hessians have right dimensions (=clique size)
   void report(const arr& phi=NoArr);
@@ -27,10 +31,13 @@ struct Conv_KOMO_ConstrainedProblem : ConstrainedProblem {
   uintA variableDimensions, varDimIntegral;
   uintA featureTimes;
   ObjectiveTypeA featureTypes;
+  uintA J_rowShift; ///< sparsity pattern of J, computed from the structure (again, when phi finds that it changed)
+  uint J_width;
   arrA J_KOMO, H_KOMO;
   
   Conv_KOMO_ConstrainedProblem(KOMO_Problem& P);
   
+  void updateStructure(); ///< queries the problem's structure and computes the row shifts of J
   void phi(arr& phi, arr& J, arr& H, ObjectiveTypeA& tt, const arr& x, arr& lambda);
 };
 
@@ -27,13 +27,13 @@ void Filter::open() {
   Var<rai::KinematicWorld> modelWorld(this, "modelWorld");
   modelWorld.readAccess();
   for(rai::Frame *b:modelWorld().frames) {
-    if(b->ats["percept"]) {
+    if(b->ats()["percept"]) {
       //first check if it already is in the percept list
       bool done=false;
       for(Percept *p:percepts_filtered.get()()) if(p->bodyId==(int)b->ID) done=true;
       if(!done) {
         LOG(0) <<"ADDING this body " <<b->name <<" to the percept database, which ats:" <<endl;
-        LOG(0) <<*b <<"--" <<b->ats <<endl;
+        LOG(0) <<*b <<"--" <<b->ats() <<endl;
         rai::Shape *s=b->shape;
         switch(s->type()) {
           case rai::ST_box: {
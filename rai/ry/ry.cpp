@@ -638,6 +638,7 @@ PYBIND11_MODULE(libry, m) {
       ENUMVAL(FS,accumulatedCollisions)
       ENUMVAL(FS,jointLimits)
       ENUMVAL(FS,distance)
+      ENUMVAL(FS,sdfDistance)
 
       ENUMVAL(FS,qItself)
 
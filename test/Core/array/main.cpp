@@ -331,6 +331,202 @@ void TEST(MemoryBound){
   A.resize(1000);
   cout <<"total memory allocated = " <<rai::globalMemoryTotal <<endl;
   rai::globalMemoryBound=1ull<<30;
+  rai::globalMemoryStrict=false;
+}
+
+//===========================================================================
+
+void TEST(ArrayPool){
+  cout <<"\n*** size-class pool of the Array buffers\n";
+  //every size fits into its class, and the classes grow
+  for(uint c=0;c<rai::ArrayPool::numClasses;c++){
+    size_t s=rai::ArrayPool::classSize(c);
+    CHECK_EQ(rai::ArrayPool::sizeClass(s), (int)c, "");
+    int next = c+1<rai::ArrayPool::numClasses ? c+1 : -1;
+    CHECK_EQ(rai::ArrayPool::sizeClass(s+1), next, "");
+  }
+  CHECK_EQ(rai::ArrayPool::classSize(rai::ArrayPool::numClasses-1), rai::ArrayPool::maxBytes, "");
+
+  //short-lived temporaries of KOMO-like sizes: 3-vectors, 3xN Jacobians
+  uint64_t mem = rai::globalMemoryTotal;
+  double sum=0., time[2];
+  for(uint pool=0;pool<2;pool++){
+    rai::ArrayPool::enabled = pool;
+    rai::timerStart();
+    for(uint i=0;i<200000;i++){
+      arr y(3), J(3, 7+i%20), H = ~J*J;
+      y = J*ones(J.d1);
+      sum += y(0) + H(0,0);
+    }
+    time[pool] = rai::timerRead();
+  }
+  rai::ArrayPool::report(cout);
+  cout <<"malloc: " <<time[0] <<"sec  pool: " <<time[1] <<"sec" <<endl;
+
+  rai::ArrayPool::Stats stats[rai::ArrayPool::numClasses];
+  rai::ArrayPool::getStats(stats);
+  uint64_t allocs=0, hits=0;
+  for(auto& s:stats){ allocs+=s.allocs; hits+=s.hits; }
+  CHECK_GE(hits, allocs*9/10, "the pool should serve almost all temporaries");
+  rai::ArrayPool::enabled = false;
+  rai::ArrayPool::releaseThreadCache();
+  CHECK_EQ(rai::globalMemoryTotal, mem, "released cached blocks must not count as allocated");
+}
+
+//===========================================================================
+
+static arr arenaTemporaries(uint n, arr& out){
+  arr x(n), A = 2.*eye(n);
+  for(uint i=0;i<n;i++) x(i)=i;
+  out = A*x; //an output of the caller: copied out of the arena
+  return ~A*x + 1.; //the return value lives in the caller's frame
+}
+
+void TEST(ArrayArena){
+  cout <<"\n*** arena scopes for temporaries\n";
+  arr out, ret, x(20);
+  for(uint i=0;i<x.N;i++) x(i)=i;
+  { rai::ArrayArena arena;  ret = arenaTemporaries(20, out); } //warm up
+  randn(1); //(the first call of the random generator may allocate)
+
+  uint64_t mem = rai::globalMemoryTotal;
+  size_t capacity = rai::ArrayArena::capacity();
+  CHECK_GE(capacity, 1, "");
+  for(uint k=0;k<100;k++){
+    {
+      rai::ArrayArena arena;
+      ret = arenaTemporaries(20, out);
+      arr tmp = out;
+      {
+        rai::ArrayArena inner;
+        arr scratch = randn(50, 50);
+      }
+      CHECK_EQ(tmp, out, "a nested scope overwrote a temporary of the outer one");
+    }
+    { rai::ArrayArena arena;  arr overwrite = zeros(100, 100); } //reuses the block
+    CHECK_EQ(out, 2.*x, "");
+    CHECK_EQ(ret, 2.*x+1., "");
+  }
+  CHECK_EQ(rai::globalMemoryTotal, mem, "the temporaries should not allocate");
+  CHECK_EQ(rai::ArrayArena::capacity(), capacity, "the arena block should be reused");
+  cout <<"arena capacity: " <<capacity <<" bytes" <<endl;
+  rai::ArrayArena::release();
+  CHECK_EQ(rai::ArrayArena::capacity(), 0, "");
+}
+
+//===========================================================================
+
+void TEST(SmallArrays){
+  cout <<"\n*** small arrays live inline, without heap allocation\n";
+  uint64_t allocs = rai::globalMemoryAllocations;
+  arr a = {1., 2., 3.};
+  CHECK((char*)a.p>=(char*)&a && (char*)a.p<(char*)(&a+1), "a 3-vector should be stored inline");
+  a.append(4.);  a.append(5.);
+  arr b = a, q(4);
+  CHECK_EQ(rai::globalMemoryAllocations, allocs, "");
+
+  //growing beyond the inline buffer moves to the heap
+  for(uint i=6;i<=20;i++) a.append(i);
+  CHECK((char*)a.p<(char*)&a || (char*)a.p>=(char*)(&a+1), "");
+  for(uint i=0;i<20;i++) CHECK_EQ(a(i), i+1, "");
+  CHECK_EQ(b, arr({1., 2., 3., 4., 5.}), "");
+  arrA A(10);
+  for(uint i=0;i<A.N;i++) A(i) = b;
+  A.resizeCopy(100); //copies the inline elements into new Array objects
+  for(uint i=0;i<10;i++) CHECK_EQ(A(i), b, "");
+
+  //references: becoming one releases the own (inline) buffer; inline buffers can't be taken over
+  arr r = {1., 2.};
+  CHECK(r.isInline(), "");
+  r.referTo(b);
+  CHECK(!r.isInline() && r.p==b.p, "");
+  r.clear();
+  r.resize(3);
+  CHECK(r.isInline(), "the inline buffer should be free again");
+  r.referTo(a);
+  arr c;
+  c.takeOver(a);
+  CHECK(!c.isInline() && a.reference && a.p==c.p && c.N==20, "");
+  bool caught=false;
+  try{
+    c.takeOver(b);
+  }catch(...){
+    caught=true;
+  }
+  CHECK(caught && b.isInline() && !b.reference, "taking over an inline buffer should fail");
+
+  //microbenchmark: 3-, 4- and 7-vector arithmetic (inline) vs 9-vectors (heap)
+  for(uint n:{3u, 4u, 7u, 9u}){
+    allocs = rai::globalMemoryAllocations;
+    double sum=0.;
+    rai::timerStart();
+    for(uint i=0;i<1000000;i++){
+      arr x(n), y(n);
+      x = (double)i;
+      y = x + 1.;
+      sum += y.p[n-1];
+    }
+    double time = rai::timerRead();
+    cout <<"n=" <<n <<": " <<time <<"sec, " <<(rai::globalMemoryAllocations-allocs) <<" heap allocations (sum=" <<sum <<")" <<endl;
+  }
+}
+
+//===========================================================================
+
+static arr arenaResult(uint n, bool zero){
+  arr a = zeros(n), b = ones(n); //temporaries in the arena
+  const double *pb = b.p;
+  arr c = std::move(b); //within the scope: takes over the arena buffer
+  CHECK_EQ(c.p, pb, "");
+  if(zero) return a;
+  return c; //(two candidates: no copy elision) moved to the caller -- or copied out of the arena
+}
+
+void TEST(ArrayMove){
+  cout <<"\n*** move constructor and assignment\n";
+  randn(1); //warm up
+  uint64_t copies = rai::globalMemoryCopies;
+  arr a = randn(100), a0 = a;
+  const double *p = a.p;
+  arr b = std::move(a); //takes over the buffer
+  CHECK_EQ(b.p, p, "");
+  CHECK(!a.N && !a.p, "a moved-from array is empty");
+  CHECK_EQ(b, a0, "");
+  a = randn(10, 10);
+  p = a.p;
+  b = std::move(a);
+  CHECK_EQ(b.p, p, "");
+  CHECK_EQ(b.nd, 2, "");
+  CHECK_EQ(rai::globalMemoryCopies, copies+1, "only a0 should be a copy");
+
+  //inline buffers are copied
+  arr s = {1., 2., 3.}, t = std::move(s);
+  CHECK((char*)t.p>=(char*)&t && (char*)t.p<(char*)(&t+1), "");
+  CHECK_EQ(t, arr({1., 2., 3.}), "");
+
+  //moving to a subarray writes into it
+  arr M = zeros(3, 100);
+  M[1] = ones(100);
+  CHECK_EQ(sum(M), 100., "");
+
+  //arena memory is copied out to arrays outside of the scope
+  arr r;
+  { rai::ArrayArena arena;  r = arenaResult(100, false); }
+  CHECK(!rai::ArrayArena::owns(r.p), "");
+  { rai::ArrayArena arena;  arr overwrite = arenaResult(1000, true); }
+  CHECK_EQ(r, ones(100), "");
+  rai::ArrayArena::release();
+
+  //returns by value and expressions: no copies
+  arr A = randn(50, 20), x = randn(50), y;
+  y = comp_At(A);  y = comp_At_x(A, x) + 1.;  y = ~A*x; //warm up
+  copies = rai::globalMemoryCopies;
+  for(uint i=0;i<100;i++){
+    y = comp_At(A);
+    y = comp_At_x(A, x) + 1.;
+    y = ~A*x;
+  }
+  CHECK_EQ(rai::globalMemoryCopies, copies, "");
 }
 
 //===========================================================================
@@ -864,7 +1060,11 @@ int MAIN(int argc, char **argv){
   testStdVectorCompat();
   testMatlab();
   testException();
-//  testMemoryBound();
+  testMemoryBound();
+  testArrayPool();
+  testArrayArena();
+  testSmallArrays();
+  testArrayMove();
   testBinaryIO();
   testExpression();
   testPermutation();
@@ -0,0 +1,126 @@
+#include <Core/array.h>
+#include <Core/util.h>
+#include <functional>
+#include <iomanip>
+
+//===========================================================================
+//
+// times the element-wise Array operations with the SIMD kernels of each
+// supported instruction set against the scalar loops (rai::simdLevel=0), on
+// large buffers like point clouds (double) and images (float), and checks
+// that the results agree. (The kernels are compiled with the flags of
+// libCore: for meaningful numbers build both with OPTIM=fast)
+//
+
+static const char* levelName[3] = { "scalar", "AVX2", "AVX-512" };
+
+template<class T> struct Op {
+  const char *name;
+  std::function<double(rai::Array<T>& z)> f; ///< updates z (initialized to x), or returns a reduction of it
+  double tol;                              ///< relative tolerance w.r.t. the scalar loop (sums: the error bound of the sequential sum)
+};
+
+/// max_i |a_i-b_i| / max_i |b_i|
+template<class T> double relDiff(const rai::Array<T>& a, const rai::Array<T>& b) {
+  double d = maxDiff(a, b), m = absMax(b);
+  return m>0. ? d/m : d;
+}
+
+template<class T> void benchmark(const char *name, uint n, uint reps, double eps) {
+  rai::Array<T> x(n), y(n);
+  rndUniform(x, -5., 5.);
+  rndUniform(y, .5, 2.);
+  T s=1.5;
+
+  Op<T> ops[] = {
+    { "z += y",           [&](rai::Array<T>& z) { z += y; return 0.; }, 0. },
+    { "z -= y",           [&](rai::Array<T>& z) { z -= y; return 0.; }, 0. },
+    { "z *= y",           [&](rai::Array<T>& z) { z *= y; return 0.; }, 0. },
+    { "z += s",           [&](rai::Array<T>& z) { z += s; return 0.; }, 0. },
+    { "z *= s",           [&](rai::Array<T>& z) { z *= s; return 0.; }, 0. },
+    { "z / s",            [&](rai::Array<T>& z) { z = z/s; return 0.; }, 0. },
+    { "exp(z)",           [&](rai::Array<T>& z) { z = exp(z); return 0.; }, 2.*eps },
+    { "sqrt(y)",          [&](rai::Array<T>& z) { z = sqrt(y); return 0.; }, 0. },
+    { "fabs(z)",          [&](rai::Array<T>& z) { z = fabs(z); return 0.; }, 0. },
+    { "sigm(z)",          [&](rai::Array<T>& z) { z = sigm(z); return 0.; }, 4.*eps },
+    { "sumOfSqr(z)",      [&](rai::Array<T>& z) { return sumOfSqr(z); }, n*eps },
+    { "scalarProduct(z,y)", [&](rai::Array<T>& z) { return scalarProduct(z, y); }, n*eps },
+    { "maxDiff(z,y)",     [&](rai::Array<T>& z) { return maxDiff(z, y); }, 0. },
+  };
+
+  cout <<"\n-- " <<name <<" (n=" <<n <<"), msec per call:\n" <<std::setw(20) <<"";
+  for(int l=0; l<=rai::simdSupported; l++) cout <<std::setw(10) <<levelName[l];
+  cout <<std::setw(10) <<"speedup" <<endl;
+
+  for(Op<T>& op:ops) {
+    rai::Array<T> z, z0;
+    double r, r0=0., time[3];
+    cout <<std::setw(20) <<op.name;
+    for(int l=0; l<=rai::simdSupported; l++) {
+      rai::simdLevel=l;
+      time[l]=0.;
+      for(uint k=0; k<reps; k++) {
+        z=x;
+        double t=rai::realTime();
+        r = op.f(z);
+        time[l] += rai::realTime()-t;
+      }
+      if(!l) { z0=z; r0=r; } else {
+        double d = r0 ? fabs(r-r0)/fabs(r0) : relDiff(z, z0);
+        CHECK_LE(d, op.tol, op.name <<" with " <<levelName[l] <<" differs from the scalar loop");
+      }
+      cout <<std::setw(10) <<std::setprecision(3) <<1e3*time[l]/reps;
+    }
+    cout <<std::setw(9) <<std::setprecision(3) <<time[0]/time[rai::simdSupported] <<'x' <<endl;
+  }
+  rai::simdLevel=rai::simdSupported;
+}
+
+//===========================================================================
+
+void TEST(Correctness) {
+  //all lengths around the vector widths (the scalar tails), and the special values of exp and sigm
+  for(uint n=rai::simdMinN; n<70; n++) {
+    arr x = randn(n)*100., y = rand(n)+.5;
+    x(0)=1000.;  x(1)=-1000.;  x(n-1)=NAN;
+    floatA xf(n), yf(n);
+    copy(xf, x);  copy(yf, y);
+    for(int l=1; l<=rai::simdSupported; l++) {
+      rai::simdLevel=0;
+      arr a = (x+y)*2.-y, b = exp(x), c = sigm(x);
+      floatA af = (xf+yf)*2.f-yf;
+      double sa = sumOfSqr(y), ma = maxDiff(x, y);
+      rai::simdLevel=l;
+      CHECK_EQ(maxDiff(a, (x+y)*2.-y), 0., "");
+      CHECK_EQ(maxDiff(af, (xf+yf)*2.f-yf), 0., "");
+      arr b1 = exp(x), c1 = sigm(x);
+      CHECK(std::isnan(b1(n-1)) && std::isnan(c1(n-1)), "");
+      b1(n-1) = b(n-1) = c1(n-1) = c(n-1) = 0.;
+      CHECK_EQ(b1(0), b(0), "");  CHECK_EQ(b1(1), b(1), ""); //inf and 0, from ::exp
+      b1(0) = b(0) = b1(1) = b(1) = 1.;
+      rai::simdLevel=0;
+      CHECK_LE(maxDiff(b1/b, ones(n)), 4e-16, "");
+      CHECK_LE(maxDiff(c1, c), 4e-16, "");
+      rai::simdLevel=l;
+      CHECK_LE(fabs(sumOfSqr(y)-sa), 1e-14*sa, "");
+      CHECK_EQ(maxDiff(x, y), ma, ""); //ignores the NaN
+    }
+  }
+  rai::simdLevel=rai::simdSupported;
+}
+
+//===========================================================================
+
+int MAIN(int argc,char** argv){
+  rai::initCmdLine(argc,argv);
+
+  cout <<"SIMD support of this CPU: " <<levelName[rai::simdSupported] <<endl;
+
+  testCorrectness();
+
+  benchmark<double>("point cloud, 100k points", 300000, 50, 1.1e-16);
+  benchmark<double>("small matrix (in cache)", 1000, 5000, 1.1e-16);
+  benchmark<float>("image, 640x480 RGB", 640*480*3, 50, 6e-8);
+
+  return 0;
+}
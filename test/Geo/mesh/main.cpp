@@ -4,6 +4,8 @@
 #include <Geo/mesh.h>
 #include <Gui/opengl.h>
 #include <Geo/qhull.h>
+#include <Geo/pairCollision.h>
+#include <Geo/meshBVH.h>
 
 void drawInit(void*){
   glStandardLight(NULL);
@@ -149,6 +151,109 @@ void TEST(GJK) {
 
 //===========================================================================
 
+void TEST(GJKWarmStart) {
+  rai::Mesh A, B;
+  A.setRandom();  A.scale(.2);
+  B.setRandom();  B.scale(.2);
+  rai::Transformation t1, t2;
+  t1.setZero();
+  t2.setZero();  t2.pos.set(.5, 0., 0.);
+
+  //small motions: restarting from the previous simplex gives the same result in fewer iterations
+  PairCollisionSeed seed;
+  uint it0=0, it1=0, N=1000;
+  for(uint i=0;i<N;i++){
+    t1.addRelativeTranslation(.01*rnd.gauss(), .01*rnd.gauss(), .01*rnd.gauss());
+    t2.addRelativeRotationDeg(1., 0., 1., 1.);
+    PairCollision coll(A, B, t1, t2);
+    PairCollision warm(A, B, t1, t2, 0., 0., &seed);
+    //(below GJK's contact tolerance EPSILON, the cold start may stop early on a penetrating pair -- compare only clear cases)
+    if(coll.distance>1e-4) CHECK_ZERO(coll.distance-warm.distance, 1e-10, "warm start changed the distance");
+    it0 += coll.iterations;
+    it1 += warm.iterations;
+  }
+  cout <<"GJK iterations per query: " <<double(it0)/N <<" (warm start: " <<double(it1)/N <<")" <<endl;
+  CHECK_LE(it1, it0, "");
+}
+
+//===========================================================================
+
+void TEST(SignedDistanceField) {
+  rai::Mesh S;
+  S.setSphere(4);
+  S.scale(.2);
+  rai::Transformation t;
+  t.setZero();
+  DistanceFunction_SDF sdf(t, S, .005, .05, "z.sdf");
+  DistanceFunction_Sphere sphere(t, .2);
+
+  //within the band, the baked mesh distances match the analytic sphere
+  double err=0.;
+  for(uint i=0;i<1000;i++){
+    arr x = .2*randn(3);
+    double d = sphere.f(NoArr, NoArr, x);
+    if(fabs(d)<.04) err = rai::MAX(err, fabs(sdf(NoArr, NoArr, x) - d));
+  }
+  cout <<"SDF max error in band: " <<err <<endl;
+  CHECK_LE(err, .002, "");
+
+  //the second bake reads the cache file
+  DistanceFunction_SDF cached(t, S, .005, .05, "z.sdf");
+  CHECK(cached.D==sdf.D, "reading the SDF cache failed");
+}
+
+//===========================================================================
+
+void TEST(MeshBVH) {
+  rai::Mesh M;
+  M.setSphere(5);
+  M.scale(.2, .1, .3);
+  rai::MeshBVH bvh(M);
+  rai::MeshBVH brute(M, M.T.d0); //a single leaf: linear in the triangles
+
+  //ray casts, closest points and the support function agree with brute force
+  uint hits=0;
+  for(uint i=0;i<1000;i++){
+    rai::Vector o(.5*randn(3)), d = rai::Vector(.1*randn(3))-o, x(.3*randn(3)), p, q;
+    double t, tb;
+    uint tri, trib;
+    bool hit = bvh.rayCast(t, tri, o, d);
+    CHECK_EQ(hit, brute.rayCast(tb, trib, o, d), "BVH ray cast differs from brute force");
+    if(hit){
+      hits++;
+      CHECK_ZERO(t-tb, 1e-10, "BVH ray cast differs from brute force");
+      CHECK_ZERO(bvh.closestPoint(q, trib, o+t*d), 1e-10, "the ray hit is not on the surface");
+    }
+
+    double dist = bvh.closestPoint(p, tri, x);
+    CHECK_ZERO(dist-brute.closestPoint(q, trib, x), 1e-10, "BVH closest point differs from brute force");
+    CHECK_ZERO((p-x).length()-dist, 1e-10, "");
+
+    arr D = conv_vec2arr(d);
+    double best = max(M.V*D);
+    CHECK_ZERO(scalarProduct(D, M.V[bvh.support(d)]) - best, 1e-10, "BVH support differs");
+    CHECK_ZERO(scalarProduct(D, M.V[M.support(D)]) - best, 1e-10, "Mesh::support differs");
+  }
+  cout <<"BVH: " <<bvh.nodes.N <<" nodes over " <<M.T.d0 <<" triangles, " <<hits <<" ray hits" <<endl;
+
+  //Mesh::support uses the mesh's own BVH, which is rebuilt when the mesh changes
+  std::shared_ptr<const rai::MeshBVH> b = M.getBVH();
+  CHECK(M.getBVH()==b, "");
+  M.scale(2., 1., .5);
+  CHECK(M.getBVH()!=b, "the BVH of a scaled mesh was not rebuilt");
+  rai::Mesh C = M;
+  CHECK(C.getBVH()!=M.getBVH(), "a copy must not use the BVH of the original");
+  C.V.append(ARR(0., 0., 10.)); //a vertex outside all triangles: the linear scan
+  C.V.reshape(C.V.N/3, 3);
+  for(uint i=0;i<100;i++){
+    arr D = randn(3);
+    CHECK_ZERO(scalarProduct(D, M.V[M.support(D)]) - max(M.V*D), 1e-10, "Mesh::support differs after scaling");
+    CHECK_ZERO(scalarProduct(D, C.V[C.support(D)]) - max(C.V*D), 1e-10, "Mesh::support ignores a vertex");
+  }
+}
+
+//===========================================================================
+
 void TEST(Volume){
   rai::Mesh m;
   for(uint k=1;k<10;k++){
@@ -278,6 +383,9 @@ int MAIN(int argc, char** argv){
   testMeshes2();
   testMeshes3();
   testGJK();
+  testGJKWarmStart();
+  testSignedDistanceField();
+  testMeshBVH();
   testVolume();
   testDistanceFunctions();
   testDistanceFunctions2();
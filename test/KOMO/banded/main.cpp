@@ -0,0 +1,113 @@
+#include <KOMO/komo.h>
+#include <Optim/lagrangian.h>
+
+//===========================================================================
+//
+// compares the envelope Cholesky of RowShifted::Ainv_b_sym with the generic
+// banded lapack solver (dpbsv, band padded to the widest slice) on the
+// Newton systems of KOMO problems. (OptNewton solves with lapack_Ainv_b_sym:
+// dpbsv, or the envelope Cholesky in builds without lapack)
+//
+
+void benchmark(KOMO& komo, uint reps=20){
+  Conv_KOMO_ConstrainedProblem P(komo.komo_problem);
+  LagrangianProblem L(P);
+  L.mu = L.nu = 10.;
+
+  arr x = komo.x;
+  rndGauss(x, .1, true);
+  arr g, H;
+  L.lagrangian(g, H, x);
+  for(uint i=0; i<H.d0; i++) H(i,0) += 1e-2; //damping, as in OptNewton::step
+
+  arr x1, x2;
+  double t1=0., t2=0., t;
+  for(uint k=0; k<reps; k++) {
+    t=rai::realTime();
+    x1 = castRowShifted(H)->Ainv_b_sym(-g);
+    t1 += rai::realTime()-t;
+    t=rai::realTime();
+    x2 = lapack_Ainv_b_sym(H, -g);
+    t2 += rai::realTime()-t;
+  }
+
+  //(the Hessians can be badly conditioned: compare the residuals, not the solutions)
+  arr Hd = unpack(H);
+  double r1 = absMax(Hd*x1+g)/absMax(g), r2 = absMax(Hd*x2+g)/absMax(g);
+  cout <<"  dim=" <<H.d0 <<" packed width=" <<H.d1
+       <<"\n  envelope Cholesky: " <<1e3*t1/reps <<"msec  relative residual=" <<r1
+       <<"\n  lapack dpbsv:      " <<1e3*t2/reps <<"msec  relative residual=" <<r2 <<endl;
+  CHECK_ZERO(r1, 1e-12, "envelope Cholesky failed");
+}
+
+//===========================================================================
+
+void TEST(Path){
+  rai::KinematicWorld K("model.g");
+  K.optimizeTree(false);
+
+  KOMO komo;
+  komo.setModel(K, false);
+  komo.setPathOpt(2.5, 100., 5.);
+  komo.setSquaredQAccelerations();
+  komo.addObjective({1.}, OT_eq, FS_positionDiff, {"endeff", "stickTip"}, {1e1});
+  komo.reset();
+
+  cout <<"-- path (constant slice dimensions)" <<endl;
+  benchmark(komo);
+}
+
+//===========================================================================
+
+void TEST(Switches){
+  rai::KinematicWorld K("model.g");
+  K.optimizeTree(false);
+
+  KOMO komo;
+  komo.setModel(K, false);
+  komo.setPathOpt(2.5, 100., 5.);
+  komo.setSquaredQAccelerations();
+  komo.add_touch(1., 1., "endeff", "stickTip");
+  komo.addSwitch_stable(1., -1., "endeff", "stickTip");
+  komo.add_touch(2., -1., "stick", "redBall");
+  komo.reset();
+
+  cout <<"-- switches (slice dimensions change after the grasp)" <<endl;
+  benchmark(komo);
+}
+
+//===========================================================================
+
+void TEST(Fallback){
+  //a symmetric RowShifted matrix that is not shifted as an upper triangle is solved densely
+  uint n=10;
+  arr A = randn(n,n);
+  A = ~A*A + eye(n);
+  arr b = randn(n);
+  arr Z = packRowShifted(A);
+  castRowShifted(Z)->symmetric = true;
+  CHECK(castRowShifted(Z)->rowShift(n-1)!=n-1, "");
+  arr x = castRowShifted(Z)->Ainv_b_sym(b);
+  CHECK_ZERO(absMax(A*x-b), 1e-10, "");
+  
+  //a non pos-def matrix throws
+  A(0,0) = -1.;
+  Z = packRowShifted(A);
+  for(uint i=0; i<n; i++) castRowShifted(Z)->rowShift(i) = i; //(only the upper triangle is read)
+  castRowShifted(Z)->symmetric = true;
+  bool thrown=false;
+  try { castRowShifted(Z)->Ainv_b_sym(b); } catch(const std::runtime_error& err) { thrown=true; }
+  CHECK(thrown, "");
+}
+
+//===========================================================================
+
+int main(int argc,char** argv){
+  rai::initCmdLine(argc,argv);
+
+  testPath();
+  testSwitches();
+  testFallback();
+
+  return 0;
+}
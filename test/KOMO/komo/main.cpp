@@ -117,12 +117,277 @@ void TEST(FinalPosePR2){
 
 //===========================================================================
 
+void TEST(ThreadedPhi){
+  //the features evaluated by the thread pool (one job per objective) are bit-identical to the serial evaluation
+  rai::KinematicWorld K("arm.g");
+  arr x, phi[2];
+  arrA J[2];
+  for(uint k=0; k<2; k++) {
+    KOMO_ext komo;
+    komo.threads = (k ? 4 : 1);
+    komo.setModel(K, true);
+    komo.setPathOpt(1., 20, 5.);
+    komo.setSquaredQAccelerations();
+    komo.setPosition(1., 1., "endeff", "target", OT_sos);
+    komo.setSlowAround(1., .05);
+    komo.add_collision(false);
+    komo.reset();
+    if(!k) { rnd.seed(0); x = komo.x + .1*randn(komo.x.N); }
+    komo.komo_problem.getStructure(NoUintA, NoUintA, NoTermTypeA);
+    komo.komo_problem.phi(phi[k], J[k], NoArrA, NoUintA, NoTermTypeA, x, NoArr);
+  }
+  CHECK_EQ(phi[0].N, phi[1].N, "");
+  CHECK_ZERO(maxDiff(phi[0], phi[1]), 0., "threaded phi differs from serial");
+  for(uint i=0; i<J[0].N; i++) CHECK_ZERO(maxDiff(J[0](i), J[1](i)), 0., "threaded J differs from serial in row " <<i);
+}
+
+//===========================================================================
+
+/// the dense Jacobian of the features, assembled from the per-feature Jacobians of the KOMO_Problem
+static arr denseJ(KOMO& komo, const arr& x) {
+  uintA dims, times;
+  komo.komo_problem.getStructure(dims, times, NoTermTypeA);
+  uintA dimsIntegral = integral(dims);
+  arr phi;
+  arrA J;
+  komo.komo_problem.phi(phi, J, NoArrA, NoUintA, NoTermTypeA, x, NoArr);
+  arr Jd = zeros(phi.N, x.N);
+  for(uint i=0; i<phi.N; i++) {
+    uint t=times(i), col = (t>komo.k_order ? dimsIntegral(t-komo.k_order-1) : 0);
+    for(uint j=0; j<J(i).N; j++) Jd(i, col+j) = J(i).elem(j);
+  }
+  return Jd;
+}
+
+void TEST(RowShiftedJ){
+  //the RowShifted J of the converted problem equals the dense J -- also after the structure changed
+  rai::KinematicWorld K("arm.g");
+  KOMO_ext komo;
+  komo.setModel(K, true);
+  komo.setPathOpt(1., 20, 5.);
+  komo.setSquaredQAccelerations();
+  komo.setPosition(1., 1., "endeff", "target", OT_sos);
+  komo.add_collision(false);
+  komo.reset();
+  rnd.seed(0);
+  arr x = komo.x + .1*randn(komo.x.N);
+
+  Conv_KOMO_ConstrainedProblem P(komo.komo_problem);
+  arr phi, J;
+  for(uint k=0; k<2; k++) {
+    if(k) { //add features after P computed its structure
+      komo.setSlowAround(1., .05);
+      komo.komo_problem.getStructure(NoUintA, NoUintA, NoTermTypeA);
+    }
+    P.phi(phi, J, NoArr, NoTermTypeA, x, NoArr);
+    CHECK(isRowShifted(J), "");
+    arr Jd = denseJ(komo, x);
+    CHECK_EQ(J.d0, Jd.d0, "");
+    CHECK_ZERO(maxDiff(unpack(J), Jd), 0., "RowShifted J differs from the dense J");
+  }
+}
+
+//===========================================================================
+
+/// the first d joints of the configuration -- d can be changed any time
+struct TestVariableDim : Feature {
+  uint d=1;
+  virtual void phi(arr& y, arr& J, const rai::KinematicWorld& K) {
+    y = K.q({0, d-1});
+    if(!!J) { J = zeros(d, K.q.N); for(uint i=0; i<d; i++) J(i, i) = 1.; }
+  }
+  virtual uint dim_phi(const rai::KinematicWorld& K) { return d; }
+  virtual rai::String shortTag(const rai::KinematicWorld& K) { return STRING("TestVariableDim_" <<d); }
+};
+
+void TEST(VariableDim){
+  //a feature changes its dimension during the optimization: the structure is recomputed, and the multipliers of
+  //the other features are transferred
+  rai::KinematicWorld K("arm.g");
+  KOMO_ext komo;
+  komo.setModel(K, false);
+  komo.setPathOpt(1., 10, 5.);
+  komo.setSquaredQAccelerations();
+  TestVariableDim *f = new TestVariableDim;
+  Objective *ob = komo.addObjective(0., -1., f, OT_eq, NoArr, 1e1, 0);
+  uint o = komo.objectives.findValue(ob);
+  komo.reset();
+  rnd.seed(0);
+  arr x = komo.x + .1*randn(komo.x.N);
+
+  Conv_KOMO_ConstrainedProblem P(komo.komo_problem);
+  arr phi, J, lambda;
+  P.phi(phi, J, NoArr, NoTermTypeA, x, NoArr);
+  uint n=phi.N;
+  lambda = rand(n);
+  arr lambda0 = lambda;
+  uintA phiIndex0 = komo.komo_problem.phiIndex, phiDim0 = komo.komo_problem.phiDim;
+
+  f->d = 2;
+  x += .1*randn(x.N);
+  P.phi(phi, J, NoArr, NoTermTypeA, x, lambda);
+  CHECK_EQ(phi.N, n+komo.T, "");
+  CHECK_EQ(lambda.N, phi.N, "");
+  CHECK_ZERO(maxDiff(unpack(J), denseJ(komo, x)), 0., "");
+  for(uint t=0; t<komo.T; t++) for(uint i=0; i<komo.objectives.N; i++) {
+    uint m = komo.komo_problem.phiDim(t, i), M = komo.komo_problem.phiIndex(t, i);
+    if(!m) continue;
+    if(i==o) { CHECK_EQ(absMax(lambda({M, M+m-1})), 0., ""); }
+    else { CHECK_EQ(lambda({M, M+m-1}), lambda0({phiIndex0(t, i), phiIndex0(t, i)+m-1}), "multipliers not transferred"); }
+  }
+}
+
+//===========================================================================
+
+void TEST(FeatureCache){
+  //with useFeatureCache, set_x+phi only re-evaluates the features of changed slices -- the result equals the full evaluation
+  rai::KinematicWorld K("arm.g");
+  KOMO_ext komo;
+  komo.useFeatureCache = true;
+  komo.setModel(K, true);
+  komo.setPathOpt(1., 20, 5.);
+  komo.setSquaredQAccelerations();
+  komo.setPosition(1., 1., "endeff", "target", OT_sos);
+  komo.setSlowAround(1., .05);
+  komo.add_collision(false);
+  komo.reset();
+  komo.komo_problem.getStructure(NoUintA, NoUintA, NoTermTypeA);
+  rnd.seed(0);
+  arr x = komo.x + .1*randn(komo.x.N);
+  arr phi, phiFull;
+  arrA J, JFull;
+  komo.komo_problem.phi(phi, J, NoArrA, NoUintA, NoTermTypeA, x, NoArr);
+
+  for(uint k=0; k<3; k++) {
+    if(k==0) { x(3) += .1;  x(x.N-1) -= .1; } //a few slices
+    if(k==1) { //the prefix, as for a receding horizon
+      komo.configurations(0)->setJointState(komo.configurations(0)->q + .1);
+      komo.configurationChanged(0);
+    }
+    if(k==2) x += .1*randn(x.N); //all slices
+    komo.useFeatureCache = true;
+    komo.komo_problem.phi(phi, J, NoArrA, NoUintA, NoTermTypeA, x, NoArr);
+    komo.useFeatureCache = false;
+    komo.komo_problem.phi(phiFull, JFull, NoArrA, NoUintA, NoTermTypeA, x, NoArr);
+    CHECK_ZERO(maxDiff(phi, phiFull), 0., "cached phi differs after change " <<k);
+    for(uint i=0; i<J.N; i++) CHECK_ZERO(maxDiff(J(i), JFull(i)), 0., "cached J differs in row " <<i <<" after change " <<k);
+  }
+}
+
+//===========================================================================
+
+static void setupMultiStart(KOMO_ext& komo, const rai::KinematicWorld& K) {
+  komo.setModel(K, true);
+  komo.setPathOpt(1., 10, 5.);
+  komo.setSquaredQAccelerations();
+  komo.setPosition(1., 1., "endeff", "target", OT_sos);
+  komo.setSlowAround(1., .05);
+  komo.add_collision(false);
+  komo.reset(0.);
+}
+
+void TEST(MultiStart){
+  //the starts are ranked by costs; the ranking doesn't depend on the number of threads; stopCosts ends the search early
+  rai::KinematicWorld K("arm.g");
+  KOMO_RestartL R[2];
+  for(uint k=0; k<2; k++) {
+    KOMO_ext komo;
+    setupMultiStart(komo, K);
+    rnd.seed(0);
+    R[k] = komo.optimizeMultiStart(6, (k ? 4 : 1), .3);
+    CHECK_EQ(R[k].size(), 6, "");
+    for(uint i=1; i<R[k].size(); i++) CHECK_LE(R[k][i-1].costs, R[k][i].costs, "not ranked by costs");
+    CHECK_ZERO(maxDiff(komo.x, R[k][0].x), 0., "x is not the best start");
+  }
+  for(uint i=0; i<R[0].size(); i++) {
+    CHECK_EQ(R[0][i].start, R[1][i].start, "ranking differs between 1 and 4 threads");
+    CHECK_ZERO(maxDiff(R[0][i].x, R[1][i].x), 1e-10, "start " <<R[0][i].start <<" differs between 1 and 4 threads");
+  }
+
+  for(uint k=0; k<2; k++) {
+    KOMO_ext komo;
+    setupMultiStart(komo, K);
+    rnd.seed(0);
+    uint threads = (k ? 4 : 1);
+    KOMO_RestartL S = komo.optimizeMultiStart(12, threads, .3, 1e10); //any completed start meets the stopCosts
+    CHECK_GE(S.size(), 1, "");
+    CHECK_LE(S.size(), threads, "starts were run after the stopCosts were met");
+    CHECK(!S[0].aborted && S[0].costs<=1e10, "");
+    if(k==0) { CHECK_EQ(S[0].start, 0, ""); }
+    for(uint i=1; i<S.size(); i++) CHECK(S[i].aborted || !S[i-1].aborted, "aborted starts are not ranked last");
+  }
+}
+
+//===========================================================================
+
+static void setupShiftHorizon(KOMO_ext& komo, const rai::KinematicWorld& K) {
+  komo.verbose = 0;
+  komo.setModel(K, false);
+  komo.setPathOpt(1., 10, 5.);
+  komo.setSquaredQAccelerations();
+  komo.setPosition(.5, 1., "endeff", "target", OT_eq);
+  komo.reset(0.);
+}
+
+void TEST(ShiftHorizon){
+  //x and dual move by one slice; re-solving from this warm start gives the solution of a fresh KOMO on the shifted
+  //window -- also over several cycles
+  rai::KinematicWorld K("arm.g");
+  KOMO_ext komo;
+  setupShiftHorizon(komo, K);
+  komo.run();
+  for(uint k=0; k<3; k++) {
+    arr x0 = komo.x, dual0 = komo.dual, q1 = komo.configurations(komo.k_order)->getJointState();
+    uintA phiIndex0 = komo.komo_problem.phiIndex, phiDim0 = komo.komo_problem.phiDim;
+    CHECK(absMax(dual0)>0., "");
+
+    komo.shiftHorizon();
+    uint n = komo.dim_x(0), T = komo.T;
+    CHECK_EQ(komo.x.N, x0.N, "");
+    CHECK_EQ(komo.x({0, x0.N-n-1}), x0({n, x0.N-1}), "x is not shifted by one slice");
+    CHECK_EQ(komo.x({x0.N-n, x0.N-1}), x0({x0.N-n, x0.N-1}), "the new last slice doesn't repeat the previous last");
+    CHECK_EQ(komo.configurations(komo.k_order-1)->getJointState(), q1, "the prefix isn't the previous first slice");
+    CHECK_EQ(komo.dual.N, dual0.N, "");
+    uint shifted=0;
+    for(uint t=0; t+1<T; t++) for(uint i=0; i<komo.objectives.N; i++) {
+      uint m = komo.komo_problem.phiDim(t, i), M = komo.komo_problem.phiIndex(t, i);
+      if(!m || phiDim0(t+1, i)!=m) continue;
+      CHECK_EQ(komo.dual({M, M+m-1}), dual0({phiIndex0(t+1, i), phiIndex0(t+1, i)+m-1}), "dual is not shifted by one slice");
+      shifted++;
+    }
+    CHECK(shifted, "");
+
+    arr xWarm = komo.x;
+    komo.run();
+
+    //(the fresh KOMO starts from the same x: the problem is redundant, the solutions of other initializations differ)
+    KOMO_ext fresh;
+    setupShiftHorizon(fresh, K);
+    for(uint s=0; s<fresh.k_order; s++) {
+      fresh.configurations(s)->setJointState(komo.configurations(s)->getJointState());
+      fresh.configurationChanged(s);
+    }
+    fresh.x = xWarm;
+    fresh.run();
+    CHECK_ZERO(maxDiff(komo.x, fresh.x), 1e-2, "the warm started solution differs from a fresh KOMO on the shifted window in cycle " <<k);
+    CHECK_LE(komo.getConstraintViolations(), .5, "the warm started solution is infeasible in cycle " <<k);
+  }
+}
+
+//===========================================================================
+
 int main(int argc,char** argv){
   rai::initCmdLine(argc,argv);
 
   rnd.clockSeed();
 
   testEasy();
+  testThreadedPhi();
+  testRowShiftedJ();
+  testVariableDim();
+  testFeatureCache();
+  testMultiStart();
+  testShiftHorizon();
 //  testAlign();
 //  testPR2();
 
@@ -1,7 +1,11 @@
 #include <Kin/kin.h>
 #include <Kin/frame.h>
 #include <Kin/kin_swift.h>
+#include <Kin/kin_broadphase.h>
+#include <Kin/proxy.h>
 #include <Kin/kin_ode.h>
+#include <Kin/TM_PairCollision.h>
+#include <Geo/pairCollision.h>
 #include <Algo/spline.h>
 #include <Algo/algos.h>
 #include <Gui/opengl.h>
@@ -163,6 +167,116 @@ void TEST(QuaternionKinematics){
   }
 }
 
+//===========================================================================
+//
+// memoized Jacobians
+//
+
+void TEST(JacobianCache){
+  rai::KinematicWorld K("kinematicTestQuat.g");
+  CHECK(!K.useJacobianCache, "the cache is opt-in");
+  K.useJacobianCache = true;
+  rai::Frame *f=0;
+  for(rai::Frame *a:K.frames) if(a->joint && a->joint->type==rai::JT_quatBall) f=a;
+  CHECK(f, "");
+  rai::Frame *endeff = K.getFrameByName("endeff");
+  rai::Vector p(.1, .2, .3);
+
+  arr A1, A2, A0, J1, J2, J0;
+  K.axesMatrix(A1, f);
+  K.jacobianPos(J1, endeff, p);
+  K.axesMatrix(A2, f);
+  K.jacobianPos(J2, endeff, p);
+  uint hits, misses;
+  K.getJacobianCacheCounts(hits, misses);
+  CHECK_EQ(hits, 2, "");
+  CHECK(A1==A2 && J1==J2, "");
+
+  //move the joint's frame directly (as a simulator or a user might), without calling a KinematicWorld method
+  rai::Quaternion rot;
+  rot.setRandom();
+  f->Q.rot = rot;
+  f->X = f->parent->X * f->Q;
+  K.axesMatrix(A2, f);
+  K.getJacobianCacheCounts(hits, misses);
+  CHECK_EQ(hits, 2, "the cache served a Jacobian of the old pose");
+  K.useJacobianCache = false;
+  K.axesMatrix(A0, f);
+  CHECK_EQ(maxDiff(A2, A0), 0., "");
+  CHECK(maxDiff(A1, A0)>0., "");
+
+  //...and via the state: all entries are invalid
+  K.useJacobianCache = true;
+  arr q = K.getJointState();
+  K.setJointState(q+.1);
+  K.jacobianPos(J2, endeff, p);
+  K.useJacobianCache = false;
+  K.jacobianPos(J0, endeff, p);
+  CHECK_EQ(maxDiff(J2, J0), 0., "");
+  CHECK(maxDiff(J1, J0)>0., "");
+}
+
+//===========================================================================
+
+void TEST(ProxyJacobians){
+  //kinematicsPenetrations gives one row per proxy, kinematicsProxyCost their sum within the margin
+  rai::KinematicWorld K("man.g");
+  arr q = K.getJointState();
+  StringA pairs = {"handR", "handL", "handL", "head", "lfoot", "rightTarget", "dnArmR", "rup"};
+  for(uint k=0; k<5; k++) {
+    rndUniform(q, -.5, .5, false);
+    K.setJointState(q);
+    K.proxies.clear();
+    for(uint i=0; i<pairs.N; i+=2) {
+      rai::Proxy& p = K.proxies.append();
+      p.a = K.getFrameByName(pairs(i));
+      p.b = K.getFrameByName(pairs(i+1));
+      p.calc_coll(K);
+    }
+
+    arr y, J, yc, Jc, yd, Jd, Jp1, Jp2;
+    K.kinematicsPenetrations(y, J, false);
+    K.kinematicsProxyCost(yc, Jc, 10.);
+    arr Jsum = zeros(1, q.N);
+    for(uint i=0; i<K.proxies.N; i++) {
+      rai::Proxy& p = K.proxies(i);
+      K.jacobianPos(Jp1, p.a, p.coll->p1);
+      K.jacobianPos(Jp2, p.b, p.coll->p2);
+      p.coll->kinDistance(yd, Jd, Jp1, Jp2);
+      CHECK_ZERO(y(i)+yd.scalar(), 1e-12, "kinematicsPenetrations: wrong value in row " <<i);
+      CHECK_ZERO(maxDiff(J[i], -Jd[0]), 1e-12, "kinematicsPenetrations: wrong Jacobian in row " <<i);
+      Jsum -= Jd;
+    }
+    CHECK_ZERO(maxDiff(Jc, Jsum), 1e-12, "kinematicsProxyCost: wrong Jacobian");
+
+    //the compact distance Jacobian of TM_PairCollision agrees with the dense one
+    for(uint i=0; i<pairs.N; i+=2) {
+      TM_PairCollision tm(K, pairs(i), pairs(i+1), TM_PairCollision::_negScalar, false);
+      tm.phi(y, J, K);
+      K.jacobianPos(Jp1, K[pairs(i)], tm.coll->p1);
+      K.jacobianPos(Jp2, K[pairs(i+1)], tm.coll->p2);
+      tm.coll->kinDistance(yd, Jd, Jp1, Jp2);
+      CHECK_ZERO(maxDiff(J, -Jd), 1e-12, "TM_PairCollision: wrong Jacobian for " <<pairs(i) <<'-' <<pairs(i+1));
+    }
+  }
+
+  //the compact jacobianPos holds the dense columns, for all joint types of kinematicTests.g
+  rai::KinematicWorld G("kinematicTests.g");
+  q = G.getJointState();
+  rndUniform(q, -.5, .5, true);
+  G.setJointState(q);
+  arr J, Jp, Js;
+  uintA cols;
+  for(rai::Frame *f:G.frames) {
+    rai::Vector p = f->X * rai::Vector(.1, .2, .3);
+    G.jacobianPos(J, f, p);
+    G.jacobianPos(Jp, cols, f, p);
+    Js = zeros(3, q.N);
+    for(uint c=0; c<cols.N; c++) for(uint k=0; k<3; k++) Js(k, cols(c)) += Jp(k, c);
+    CHECK_ZERO(maxDiff(J, Js), 1e-12, "compact jacobianPos of " <<f->name);
+  }
+}
+
 //===========================================================================
 //
 // copy operator test
@@ -184,9 +298,122 @@ void TEST(Copy){
   g2.readRaw(FILE("z.2"));
 
   CHECK_EQ(g1, g2, "copy operator failed!")
+
+  //the attributes are shared until one copy writes them
+  rai::Frame *f1=G1.frames.last(), *f2=G2.frames.last();
+  CHECK_EQ(&f1->ats(), &f2->ats(), "attributes are not shared");
+  f2->getAts().newNode<bool>({"copyOnWrite"}, {}, true);
+  CHECK(&f1->ats()!=&f2->ats() && !f1->ats()["copyOnWrite"] && f2->ats()["copyOnWrite"], "copy on write failed");
+
+  //names and inertias are still copied per frame (an inertia holds per-copy forces): their share of the copy time
+  //on a 500 frame scene, against the same scene without names and inertias
+  double time[2];
+  for(uint named=0; named<2; named++) {
+    rai::KinematicWorld S;
+    for(uint i=0; i<500; i++) {
+      rai::Frame *f = named ? S.addObject(STRING("object_" <<i), rai::ST_box, {.1, .1, .1})
+                            : S.addObject(rai::ST_box, {.1, .1, .1});
+      if(i) f->linkFrom(S.frames(i/2));
+      if(named) { new rai::Inertia(*f); f->inertia->mass=1.; }
+    }
+    uint N=500;
+    rai::timerStart();
+    for(uint k=0; k<N; k++) { rai::KinematicWorld C(S); }
+    time[named] = rai::timerRead()/N;
+    rai::KinematicWorld C(S);
+    if(named) {
+      C.frames.last()->inertia->force.x = 1.;
+      CHECK(C.frames.last()->name==S.frames.last()->name && S.frames.last()->inertia->force.x==0., "");
+    }
+  }
+  cout <<"copy of 500 frames: " <<1e6*time[0] <<"us, with names and inertias: " <<1e6*time[1] <<"us" <<endl;
   cout <<"** copy operator success" <<endl;
 }
 
+//===========================================================================
+
+/// getFrameByName (via the name index) agrees with a linear scan: the first frame of that name
+void checkFrameIndex(const rai::KinematicWorld& K) {
+  StringA names = K.getFrameNames();
+  names.append(STRING("noSuchFrame"));
+  FrameL F = K.getFramesByNames(names, false);
+  for(uint i=0; i<names.N; i++) {
+    rai::Frame *f = NULL;
+    for(rai::Frame *b:K.frames) if(b->name==names(i)) { f=b; break; }
+    CHECK_EQ(K.getFrameByName(names(i), false), f, "index lookup of '" <<names(i) <<"' differs from the linear scan");
+    CHECK_EQ(F(i), f, "getFramesByNames differs for '" <<names(i) <<"'");
+  }
+}
+
+void TEST(FrameIndex){
+  rai::KinematicWorld K("kinematicTests.g");
+  checkFrameIndex(K);
+
+  //frames added by name are indexed; a duplicate name keeps finding the first frame
+  rai::Frame *a = K.addFrame("indexA", K.frames(0)->name);
+  rai::Frame *dup = K.addFrame(K.frames(1)->name);
+  CHECK_EQ(K["indexA"], a, "");
+  CHECK(K.getFrameByName(dup->name)!=dup, "a duplicate name must return the first frame");
+  rai::Frame *b = K.addObject("indexB", rai::ST_sphere, {.1});
+  CHECK_EQ(K["indexB"], b, "");
+  checkFrameIndex(K);
+  CHECK_EQ(K.getFrameIDs({"indexA", "indexB"}), uintA({a->ID, b->ID}), "");
+
+  //deleting the first of two equally named frames: the second is found
+  rai::String name = dup->name;
+  delete K.getFrameByName(name);
+  CHECK_EQ(K.getFrameByName(name), dup, "");
+  delete a;
+  CHECK(!K.getFrameByName("indexA", false), "a deleted frame is still found");
+  checkFrameIndex(K);
+
+  //a single rename is found by the fallback scan
+  b->name = "indexC";
+  CHECK(!K.getFrameByName("indexB", false), "");
+  CHECK_EQ(K["indexC"], b, "");
+
+  //copies index their own frames
+  rai::KinematicWorld K2(K);
+  for(rai::Frame *f:K2.frames) CHECK_EQ(&K2.getFrameByName(f->name)->K, &K2, "the copy's index refers to the original's frames");
+  checkFrameIndex(K2);
+  K2.addFrame("indexD");
+  CHECK(!K.getFrameByName("indexD", false), "");
+  checkFrameIndex(K2);
+
+  //bulk renames
+  K.prefixNames();
+  checkFrameIndex(K);
+  CHECK(!K.getFrameByName("indexC", false), "");
+  cout <<"** frame index success" <<endl;
+}
+
+//===========================================================================
+
+void TEST(WorldState){
+  rai::KinematicWorld K("kinematicTests.g");
+  uint n=K.getJointStateDimension();
+  arr X0 = K.getFrameState(), q0 = K.getJointState();
+
+  rai::WorldState S;
+  S.save(K);
+  FILE("z.state") <<S;
+
+  for(uint k=0;k<10;k++){
+    K.setJointState(rand(n));
+    S.restore(K);
+    CHECK_ZERO(maxDiff(K.getFrameState(), X0) + maxDiff(K.getJointState(), q0), 1e-12, "restore failed");
+  }
+
+  //read back into a copy
+  rai::KinematicWorld K2(K);
+  K2.setJointState(rand(n));
+  rai::WorldState S2;
+  FILE("z.state") >>S2;
+  S2.restore(K2);
+  CHECK_ZERO(maxDiff(K2.getFrameState(), X0), 1e-12, "reading the state failed");
+  cout <<"** world state success" <<endl;
+}
+
 //===========================================================================
 //
 // Kinematic speed test
@@ -232,6 +459,128 @@ void TEST(KinematicSpeed){
 #endif
 }
 
+//===========================================================================
+//
+// incremental forward kinematics: per-update cost when only some joints change
+//
+
+void TEST(IncrementalKinematics){
+  rai::KinematicWorld K("man.g");
+  uint n=K.getJointStateDimension();
+  arr q0 = K.getJointState();
+  rai::KinematicWorld R(K); //reference, always propagating fully
+  R.useIncrementalFK=false;
+
+  uint N=20000;
+  for(uint d:{n, n/2, 1u}){ //change all, half, or a single joint (the last ones in q)
+    double time[2];
+    for(bool incremental:{false, true}){
+      K.useIncrementalFK=incremental;
+      K.setJointState(q0);
+      arr q=q0;
+      rai::timerStart();
+      for(uint k=0;k<N;k++){
+        for(uint i=n-d;i<n;i++) q(i) = rnd.uni(-.5,.5);
+        K.setJointState(q);
+      }
+      time[incremental] = rai::timerRead();
+      R.setJointState(q);
+      for(uint i=0;i<K.frames.N;i++) CHECK_ZERO(absMax(K.frames(i)->X.getArr7d() - R.frames(i)->X.getArr7d()), 1e-12, "");
+    }
+    cout <<"changing " <<d <<" of " <<n <<" joints: per update full=" <<1e6*time[0]/N <<"us incremental=" <<1e6*time[1]/N <<"us" <<endl;
+  }
+
+  //the partial setter
+  auto checkPoses = [&K, &R](){
+    R.setJointState(K.getJointState());
+    for(uint i=0;i<K.frames.N;i++) CHECK_ZERO(absMax(K.frames(i)->X.getArr7d() - R.frames(i)->X.getArr7d()), 1e-12, "");
+  };
+  uintA joints;
+  for(rai::Joint *j:K.fwdActiveJoints) if(j->dim==1) joints.append(j->frame.ID);
+  for(uint k=0;k<10;k++){
+    uint i=rnd(joints.N);
+    K.setJointState({rnd.uni(-.5,.5)}, uintA{joints(i)});
+    checkPoses();
+  }
+
+  //direct writes of q, Q and X: by default, the next setJointState propagates fully; with useIncrementalFK, the writer
+  //has to call invalidateJacobianCache()
+  CHECK(!rai::KinematicWorld().useIncrementalFK, "");
+  rai::Frame *root=0, *rigid=0;
+  for(rai::Frame *f:K.frames) {
+    if(!f->parent && f->parentOf.N) root=f;
+    if(f->parent && !f->joint && f->parent->parent) rigid=f;
+  }
+  CHECK(root && rigid, "");
+  rai::Joint *j = K.fwdActiveJoints.last();
+  for(bool incremental:{false, true}){
+    K.useIncrementalFK=incremental;
+    arr q = K.getJointState();
+    K.setJointState(q);
+    rigid->Q.pos.x += .1;
+    root->X.pos.z += .1;
+    K.q(j->qIndex) += .2;
+    if(incremental) K.invalidateJacobianCache();
+    q = K.q;
+    q(0) += .1; //a partial update
+    rai::KinematicWorld C(K); //fully propagated copy of the directly written state
+    C.useIncrementalFK=false;
+    C.setJointState(q);
+    K.setJointState(q);
+    for(uint i=0;i<K.frames.N;i++) CHECK_ZERO(absMax(K.frames(i)->X.getArr7d() - C.frames(i)->X.getArr7d()), 1e-12, "stale pose of frame " <<K.frames(i)->name);
+  }
+}
+
+void TEST(BatchKinematics){
+  rai::KinematicWorld K("man.g");
+  uint n=K.getJointStateDimension();
+  arr q0 = K.getJointState();
+  FrameL F = {K.frames(K.frames.N/2), K.frames.last()};
+
+  uint N=2000;
+  arr Qs = randn(N, n);
+  arr Y, J, Yt, Jt;
+  rai::timerStart();
+  K.kinematicsPosBatch(Y, J, Qs, F);
+  double time = rai::timerRead();
+  K.kinematicsPosBatch(Yt, Jt, Qs, F, 4);
+  CHECK_ZERO(maxDiff(Y, Yt) + maxDiff(J, Jt), 1e-12, "threaded batch differs");
+  CHECK_ZERO(maxDiff(K.getJointState(), q0), 1e-12, "batch evaluation changed the world");
+
+  //compare with the stateful API on a few rows
+  arr y, Jy;
+  for(uint r=0;r<N;r+=N/10){
+    K.setJointState(Qs[r]);
+    for(uint i=0;i<F.N;i++){
+      K.kinematicsPos(y, Jy, F(i));
+      CHECK_ZERO(maxDiff(y, Y[r][i]) + maxDiff(Jy, J[r]({3*i, 3*i+2})), 1e-12, "");
+    }
+  }
+
+  //stacked features: the position of F(0) followed by the quaternion of F(1)
+  K.evalFeatureBatch(Yt, NoArr, Qs, {FS_position, FS_quaternion}, {{F(0)->name}, {F(1)->name}}, 4);
+  CHECK_EQ(Yt.d1, 7, "");
+  for(uint r=0;r<N;r++) CHECK_ZERO(maxDiff(Yt[r]({0,2}), Y[r][0]), 1e-12, "");
+
+  //a failing job is reported; the pool and the copies are reused afterwards, and recreated after a structure change
+  arr Qbad = Qs;
+  Qbad(N/2, 0) = NAN;
+  bool failed=false;
+  try { K.kinematicsPosBatch(Yt, Jt, Qbad, F, 4); } catch(...) { failed=true; }
+  CHECK(failed, "the NAN joint state should fail");
+  K.kinematicsPosBatch(Yt, Jt, Qs, F, 4);
+  CHECK_ZERO(maxDiff(Y, Yt) + maxDiff(J, Jt), 1e-12, "reused batch workers differ");
+  K.addFrame("batchMarker", F(0)->name, "Q:<t(0 0 .1)>");
+  K.calc_q();
+  K.kinematicsPosBatch(Yt, Jt, Qs, {K["batchMarker"]}, 4);
+  for(uint r=0;r<N;r+=N/10){
+    K.setJointState(Qs[r]);
+    K.kinematicsPos(y, NoArr, K["batchMarker"]);
+    CHECK_ZERO(maxDiff(y, Yt[r][0]), 1e-12, "batch workers of the old structure");
+  }
+  cout <<"batch kinematics: " <<1e6*time/N <<"us per joint state" <<endl;
+}
+
 //===========================================================================
 //
 // SWIFT and contacts test
@@ -271,6 +620,42 @@ void TEST(Contacts){
 
 //===========================================================================
 
+void TEST(Broadphase){
+  rai::KinematicWorld K;
+  uint N=100;
+  for(uint i=0;i<N;i++){
+    rai::Frame *f = K.addObject(STRING("obj" <<i), rai::ST_ssBox, {.1, .1, .1, .02});
+    f->X.pos.set(rand(3)*1.5);
+    f->X.rot.setRandom();
+    f->shape->cont=1;
+  }
+  K.calc_activeSets();
+  K.calc_q();
+  K.broadphase().setCutoff(.05);
+
+  for(uint t=0;t<5;t++){
+    for(rai::Frame *f:K.frames) f->X.pos += rai::Vector(.01*randn(3));
+    K.stepBroadphase();
+
+    //brute force: all pairs that are closer than the cutoff must be in the proxies
+    uint n=0;
+    for(uint i=0;i<N;i++) for(uint j=i+1;j<N;j++){
+      rai::Proxy p;
+      p.a=K.frames(i); p.b=K.frames(j);
+      p.calc_coll(K);
+      if(p.d>=K.broadphase().cutoff) continue;
+      n++;
+      bool found=false;
+      for(rai::Proxy& q:K.proxies) if(q.a==p.a && q.b==p.b && fabs(q.d-p.d)<1e-10) found=true;
+      CHECK(found, "broadphase missed the pair " <<p.a->name <<'-' <<p.b->name);
+    }
+    CHECK_EQ(n, K.proxies.N, "");
+  }
+  cout <<"broadphase: " <<K.proxies.N <<" proxies from " <<K.broadphase().pairs.d0 <<" candidate pairs" <<endl;
+}
+
+//===========================================================================
+
 void TEST(Limits){
   rai::KinematicWorld G("arm7.g");
 
@@ -619,15 +1004,22 @@ int MAIN(int argc,char **argv){
 
   testLoadSave();
   testCopy();
+  testFrameIndex();
+  testWorldState();
   testGraph();
   testPlayStateSequence();
   testKinematics();
   testQuaternionKinematics();
+  testJacobianCache();
+  testProxyJacobians();
   testKinematicSpeed();
+  testIncrementalKinematics();
+  testBatchKinematics();
   testFollowRedundantSequence();
   testInverseKinematics();
   testDynamics();
   testContacts();
+  testBroadphase();
   testLimits();
 #ifdef RAI_ODE
 //  testMeshShapesInOde();